@@ -32,28 +32,68 @@
 
 #pragma once
 
+#include <stdint.h>
+#include <algorithm>
 #include <deque>
 #include <list>
 #include <map>
+#include <vector>
 #include <cmath>
 #include <iostream>
 
+#include "Pool.h"
 #include "Ease.h"
+#include "EaseBezier.h"
 #include "Animator.h"
 #include "Animation.h"
 #include "Timing.h"
+#include "Events.h"
+#include "Trace.h"
+#include "Snapshot.h"
+#include "Interval.h"
+#include "Compact.h"
+#include "Batch.h"
+#include "Prototype.h"
+#include "Vector.h"
+#include "Fixed.h"
+#include "Path.h"
+#include "Spring.h"
+#include "Await.h"
 
 
 namespace rp {
+
+template <typename A, typename Source, typename Object = void> 
+class AniHandle;
+
 /*=============================================================================
           Ani: Animator Manager
 =============================================================================*/
 class Ani
 {
  public:
-  Ani () {}
+  Ani () : 
+    timeOrigin_(0), 
+    autoDispatch_(false), 
+    orderDirty_(false), 
+    updating_(false), 
+    counting_(false), 
+    active_(0), 
+    idleTicks_(0), 
+    idleDuration_(0), 
+    generation_(0) 
+  {
+    context_.intervals = &intervals_;
+  }
+  
+  ~Ani () {
+    for (animatorMap::iterator it = animators_.begin(); it != animators_.end(); ++it) {
+      delete it->second;
+    }
+  }
   
-  typedef std::map<uintptr_t, Animator*> animatorMap;
+  typedef std::map<uintptr_t, Animator*, std::less<uintptr_t>,
+                   PoolAllocator<std::pair<const uintptr_t, Animator*> > > animatorMap;
 
   // ------ mate(): retreive or create a new variable Animator ----------------
   template <typename T>
@@ -64,7 +104,7 @@ class Ani
     
     if (it == animators_.end()) {
       varAnimator<T>* anim = new varAnimator<T>(var);
-      animators_[ptr] = anim;
+      adopt(ptr, anim);
       return anim;
     } else {
       return static_cast<varAnimator<T>* >(it->second);
@@ -74,26 +114,329 @@ class Ani
   // ------ mate(): retreive or create a new function Animator ----------------
   template <typename clT, typename T, typename fnrt>
   fnctAnimator<clT, T, fnrt>* mate(clT* obj, fnrt(clT::*fnct)(T)) {
-    // Add object to function pointer to get unique address for key
-    uintptr_t ptr = reinterpret_cast<uintptr_t>(&fnct) + 
-                    reinterpret_cast<uintptr_t>(obj);
-                    
+    uintptr_t ptr = fnctKey(obj, fnct);
     animatorMap::iterator it = animators_.find(ptr);
     
     if (it == animators_.end()) {
-      fnctAnimator<clT, T, fnrt>* anim = new fnctAnimator<clT, T, fnrt>(obj, fnct);
-      animators_[ptr] = anim;
+      fnctAnimator<clT, T, fnrt>* anim = 
+        new fnctAnimator<clT, T, fnrt>(obj, fnct);
+      adopt(ptr, anim);
       return anim;
     } else {
       return static_cast<fnctAnimator<clT, T, fnrt>* >(it->second);
     }
   }
   
-  void update(const double ttime) {
+  // ------ batch(): retreive or create the bulk setter Animator for a setter -
+  // One bulk call per update for every object animated through it, see 
+  // Batch.h. The bulk setter of the first call sticks.
+  template <typename clT, typename T, typename fnrt>
+  batchAnimator<clT, T>* batch(fnrt(clT::*fnct)(T), 
+                               typename batchAnimator<clT, T>::BulkSetter bulk) 
+  {
+    uintptr_t ptr = fnctKey(static_cast<clT*>(0), fnct);
+    animatorMap::iterator it = animators_.find(ptr);
+    
+    if (it == animators_.end()) {
+      batchAnimator<clT, T>* anim = new batchAnimator<clT, T>(bulk);
+      adopt(ptr, anim);
+      return anim;
+    } else {
+      return static_cast<batchAnimator<clT, T>* >(it->second);
+    }
+  }
+  
+  // ------ relative(): retreive or create a relative variable Animator -------
+  // The variable ends up at *parent + a local offset, which is what gets 
+  // animated. mate() on the same variable returns the relative animator 
+  // afterwards. A plain animator made by mate() before is replaced, its 
+  // queued animations are dropped, they'd fight the offset.
+  template <typename T>
+  relativeAnimator<T>* relative(T* var, const T* parent) {
+    uintptr_t ptr = reinterpret_cast<uintptr_t>(var);
+    animatorMap::iterator it = animators_.find(ptr);
+    
+    if (it != animators_.end() && it->second->kind() == AnimatorKind::Relative) 
+      return static_cast<relativeAnimator<T>* >(it->second);
+    
+    bool pinned = false;
+    if (it != animators_.end()) {
+      pinned = it->second->isPinned();
+      removePtr(ptr);
+    }
+    relativeAnimator<T>* anim = new relativeAnimator<T>(var, parent);
+    anim->pin(pinned);
+    adopt(ptr, anim);
+    return anim;
+  }
+  
+  // ------ link(): update child after parent, false if it would loop ---------
+  bool link(Animator* child, Animator* parent) {
+    for (Animator* p = parent; p; p = p->getParent()) {
+      if (p == child) 
+        return false;
+    }
+    child->setParent(parent);
+    orderDirty_ = true;
+    return true;
+  }
+  void unlink(Animator* child) {
+    child->setParent(0);
+    orderDirty_ = true;
+  }
+  
+  // ------ follow(): retreive or create a path Animator ----------------------
+  template <typename T>
+  pathAnimator<T>* follow(T* var, const Path<T>* path) {
+    // Add path to variable to get unique address for key
+    uintptr_t ptr = reinterpret_cast<uintptr_t>(var) + 
+                    reinterpret_cast<uintptr_t>(path);
+                    
+    animatorMap::iterator it = animators_.find(ptr);
+    
+    if (it == animators_.end()) {
+      pathAnimator<T>* anim = new pathAnimator<T>(var, path);
+      adopt(ptr, anim);
+      return anim;
+    } else {
+      return static_cast<pathAnimator<T>* >(it->second);
+    }
+  }
+  
+  // ------ compact(): retreive or create the compact Animator for a type -----
+  template <typename T>
+  compactAnimator<T>* compact() {
+    static char tag; // unique per type, never a user variable
+    uintptr_t ptr = reinterpret_cast<uintptr_t>(&tag);
+    animatorMap::iterator it = animators_.find(ptr);
+    
+    if (it == animators_.end()) {
+      compactAnimator<T>* anim = new compactAnimator<T>(timeOrigin_);
+      adopt(ptr, anim);
+      return anim;
+    } else {
+      return static_cast<compactAnimator<T>* >(it->second);
+    }
+  }
+  
+  // ------ prototype(): new immutable prototype for a style -----------------
+  // Owned by the Ani like any other animator, remove(proto) deletes it
+  template <typename T>
+  prototypeAnimator<T>* prototype(const AnimationStyle<T>& style) {
+    prototypeAnimator<T>* anim = new prototypeAnimator<T>(style);
+    adopt(reinterpret_cast<uintptr_t>(anim), anim);
+    return anim;
+  }
+  
+  // ------ fixed(): retreive or create the buffer Animator, uint8_t or int16_t
+  template <typename T>
+  fixedAnimator<T>* fixed() {
+    static char tag; // unique per type, never a user variable
+    uintptr_t ptr = reinterpret_cast<uintptr_t>(&tag);
+    animatorMap::iterator it = animators_.find(ptr);
+    
+    if (it == animators_.end()) {
+      fixedAnimator<T>* anim = new fixedAnimator<T>();
+      adopt(ptr, anim);
+      return anim;
+    } else {
+      return static_cast<fixedAnimator<T>* >(it->second);
+    }
+  }
+  
+  // ------ springs(): retreive or create the spring Animator for a type ------
+  template <typename T>
+  springAnimator<T>* springs() {
+    static char tag; // unique per type, never a user variable
+    uintptr_t ptr = reinterpret_cast<uintptr_t>(&tag);
+    animatorMap::iterator it = animators_.find(ptr);
+    
+    if (it == animators_.end()) {
+      springAnimator<T>* anim = new springAnimator<T>();
+      adopt(ptr, anim);
+      return anim;
+    } else {
+      return static_cast<springAnimator<T>* >(it->second);
+    }
+  }
+  
+  // ------ Time origin for reduced precision storage -------------------------
+  void setTimeOrigin(const double origin) {
+    timeOrigin_ = origin;
     for ( animatorMap::iterator it = animators_.begin(); 
       it != animators_.end(); ++it )
     {
-      (*(it->second)).update(ttime);
+      (*(it->second)).rebase(origin);
+    }
+  }
+  double getTimeOrigin() {
+    return timeOrigin_;
+  }
+  
+  // ------ Deferred events ---------------------------------------------------
+  // Callbacks get recorded into a ring instead of running inside update(),
+  // dispatched right after the update pass or left for the caller to drain
+  // through events(). Only affects animations queued after the call.
+  void deferEvents(size_t capacity = 4096, bool autoDispatch = true) {
+    events_.reserve(capacity);
+    autoDispatch_ = autoDispatch;
+    context_.events = capacity ? &events_ : 0;
+  }
+  EventRing& events() {
+    return events_;
+  }
+  
+  // ------ Settling ----------------------------------------------------------
+  // Animations finish early once they're within epsilon of their final value
+  // and moved less than that in their last step: they snap to it, run their
+  // finish callback and make way for the next one. Long tails like OutExpo's
+  // stop costing updates below what can be seen. Only one-shot timings and
+  // animations queued after the call, animators can override it. 0 is off.
+  void setSettle(double epsilon) {
+    context_.settle = epsilon;
+  }
+  
+  // ------ Interval index ----------------------------------------------------
+  // Keeps the absolute start & end of every queued animation in intervals(),
+  // for "what's active or starting in [t0, t1]" queries. Only animations 
+  // queued after the call are indexed, compact records and springs never.
+  void indexIntervals(bool index = true) {
+    context_.indexing = index;
+  }
+  IntervalIndex& intervals() {
+    return intervals_;
+  }
+  
+  // ------ Idle eviction -----------------------------------------------------
+  // Animators with nothing queued for `ticks` update passes and `duration` 
+  // time units get deleted at the end of the pass, their memory goes back to
+  // the Pool. Pinned, linked, relative, compact and spring animators stay.
+  // The next mate() makes a fresh one, so settings from anim() are gone, pin
+  // those. 0, 0 turns it off.
+  void setIdlePolicy(uint32_t ticks, double duration = 0) {
+    idleTicks_ = ticks;
+    idleDuration_ = duration;
+  }
+  
+  // ------ evictIdle(): evict every idle animator now, regardless of policy --
+  // One pass over the registry, from inside a callback they go at the end of
+  // the update pass. Returns the number evicted.
+  size_t evictIdle() {
+    for (animatorMap::iterator it = animators_.begin(); it != animators_.end(); ++it) {
+      if (it->second->isEvictable()) 
+        evicted_.push_back(it->second);
+    }
+    return updating_ ? 0 : evict();
+  }
+  
+  // Bumped whenever animators are deleted, handles re-resolve on a change
+  uint32_t generation() {
+    return generation_;
+  }
+  
+  // ------ handle(): animator references that survive eviction ---------------
+  template <typename T>
+  AniHandle<varAnimator<T>, T*> handle(T* var) {
+    return AniHandle<varAnimator<T>, T*>(this, var);
+  }
+  template <typename clT, typename T, typename fnrt>
+  AniHandle<fnctAnimator<clT, T, fnrt>, fnrt(clT::*)(T), clT> 
+  handle(clT* obj, fnrt(clT::*fnct)(T)) {
+    return AniHandle<fnctAnimator<clT, T, fnrt>, fnrt(clT::*)(T), clT>(this, fnct, obj);
+  }
+  
+  // ------ Active animations -------------------------------------------------
+  // With counting on, every update pass sums up what its animators have
+  // playing. For load balancing, see Scheduler.h.
+  void countActive(bool count = true) {
+    counting_ = count;
+  }
+  size_t getActiveCount() {
+    return active_;
+  }
+  
+  // ------ Snapshots ---------------------------------------------------------
+  // Every animator the resolver has an id for, see Snapshot.h
+  void save(SnapshotWriter& out, SnapshotResolver& resolver) {
+    out.write(uint32_t(SnapshotMagic));
+    out.write(uint32_t(SnapshotVersion));
+    out.write(timeOrigin_);
+    
+    for ( animatorMap::iterator it = animators_.begin(); 
+      it != animators_.end(); ++it )
+    {
+      uint64_t id = resolver.animatorId(it->second);
+      if (!id) 
+        continue;
+      out.write(id);
+      size_t mark = out.beginBlock();
+      it->second->save(out, resolver);
+      out.endBlock(mark);
+    }
+    out.write(uint64_t(0));
+  }
+  
+  // Returns the number of animators restored. offset is how far this clock 
+  // runs ahead of the one the snapshot was saved on, e.g. after a restart
+  size_t restore(SnapshotReader& in, SnapshotResolver& resolver, 
+                 const double offset = 0) {
+    uint32_t magic = 0, version = 0;
+    in.read(magic);
+    in.read(version);
+    if (magic != SnapshotMagic || version != SnapshotVersion) 
+      return 0;
+    in.read(timeOrigin_);
+    timeOrigin_ += offset;
+    
+    size_t restored = 0;
+    uint64_t id = 0;
+    while (in.read(id) && id) {
+      SnapshotReader block = in.block();
+      Animator* anim = resolver.animator(id);
+      if (anim && anim->restore(block, resolver)) {
+        if (offset != 0) 
+          anim->shift(offset);
+        restored++;
+      }
+    }
+    return restored;
+  }
+  
+  void update(const double ttime) {
+    ANI_TRACE_SCOPE("Ani::update", this);
+    context_.now = ttime;
+    if (orderDirty_) 
+      sortAnimators();
+    
+    // Indexed, animators created by callbacks land in the next pass
+    const bool tracking = idleTicks_ || idleDuration_ > 0;
+    size_t active = 0;
+    updating_ = true;
+    for (size_t i = 0; i < order_.size(); i++) {
+      Animator* anim = order_[i];
+      if (!anim) 
+        continue; // removed during this pass
+      ANI_TRACE_SCOPE("Animator::update", anim);
+      anim->update(ttime);
+      if (counting_) 
+        active += anim->activeCount();
+      
+      if (tracking && anim->trackIdle(ttime) >= idleTicks_ && 
+          ttime - anim->getIdleSince() >= idleDuration_ && anim->isEvictable()) 
+        evicted_.push_back(anim);
+    }
+    updating_ = false;
+    if (counting_) 
+      active_ = active;
+    
+    if (!evicted_.empty()) {
+      ANI_TRACE_SCOPE("Ani::evict", this);
+      evict();
+    }
+    
+    if (context_.events && autoDispatch_) {
+      ANI_TRACE_SCOPE("Ani::dispatch", this);
+      events_.dispatch();
     }
   }
   
@@ -102,23 +445,223 @@ class Ani
     removePtr(reinterpret_cast<uintptr_t>(var));
   }
   
-  template <typename clT, typename T>
-  void remove(clT* obj, void(clT::*fnct)(T)) {
-    removePtr(reinterpret_cast<uintptr_t>(&fnct) + 
-              reinterpret_cast<uintptr_t>(obj));
+  template <typename T>
+  void remove(T* var, const Path<T>* path) {
+    removePtr(reinterpret_cast<uintptr_t>(var) + 
+              reinterpret_cast<uintptr_t>(path));
+  }
+  
+  template <typename clT, typename T, typename fnrt>
+  void remove(clT* obj, fnrt(clT::*fnct)(T)) {
+    removePtr(fnctKey(obj, fnct));
   }
   
  private:
+  // Owns its animators and they point back at context_, no copies
+  Ani (const Ani&);
+  Ani& operator=(const Ani&);
+  
+  enum { SnapshotMagic = 0x53494e41, SnapshotVersion = 1 }; // "ANIS"
+  
+  // ------ Key for function animators ----------------------------------------
+  // Member function pointers don't cast to integers, hash their bytes and
+  // add the object to get a unique key
+  template <typename clT, typename T, typename fnrt>
+  static uintptr_t fnctKey(clT* obj, fnrt(clT::*fnct)(T)) {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&fnct);
+    uintptr_t hash = 2166136261u;
+    for (size_t i = 0; i < sizeof(fnct); i++) {
+      hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return reinterpret_cast<uintptr_t>(obj) + hash;
+  }
+  
+  void adopt(uintptr_t ptr, Animator* anim) {
+    anim->setContext(&context_);
+    anim->setKey(ptr);
+    animators_[ptr] = anim;
+    orderDirty_ = true;
+  }
+  
   void removePtr(uintptr_t ptr) {
    animatorMap::iterator it = animators_.find(ptr);
    if (it != animators_.end()) {
-     animators_.erase(animators_.find(ptr));
-     delete (it->second); // remove pointer
+     Animator* anim = it->second;
+     animators_.erase(it);
+     
+     // Orphan its children and keep a running update pass away from it
+     for (it = animators_.begin(); it != animators_.end(); ++it) {
+       if (it->second->getParent() == anim) 
+         it->second->setParent(0);
+     }
+     std::replace(order_.begin(), order_.end(), anim, static_cast<Animator*>(0));
+     evicted_.erase(std::remove(evicted_.begin(), evicted_.end(), anim), evicted_.end());
+     orderDirty_ = true;
+     generation_++;
+     
+     anim->setParent(0);
+     delete anim; // remove pointer
    }
   }
+  
+  // ------ evict(): delete the collected idle animators ----------------------
+  // Sorted so duplicates go and order_ loses them in one pass, which keeps
+  // it sorted by depth
+  size_t evict() {
+    std::sort(evicted_.begin(), evicted_.end());
+    evicted_.erase(std::unique(evicted_.begin(), evicted_.end()), evicted_.end());
+    
+    size_t count = 0;
+    for (size_t i = 0; i < evicted_.size(); i++) {
+      Animator* anim = evicted_[i];
+      if (!anim->isEvictable()) 
+        continue; // picked up work since it was collected
+      animators_.erase(anim->getKey());
+      evicted_[count++] = anim;
+    }
+    evicted_.resize(count);
+    
+    if (count) {
+      order_.erase(std::remove_if(order_.begin(), order_.end(), 
+                                  IsEvicted(evicted_)), order_.end());
+      for (size_t i = 0; i < evicted_.size(); i++) {
+        delete evicted_[i];
+      }
+      generation_++;
+    }
+    evicted_.clear();
+    return count;
+  }
+  
+  struct IsEvicted
+  {
+    IsEvicted (const std::vector<Animator*>& evicted) : evicted_(evicted) {}
+    bool operator()(Animator* anim) const {
+      return std::binary_search(evicted_.begin(), evicted_.end(), anim);
+    }
+    const std::vector<Animator*>& evicted_;
+  };
+  
+  // ------ sortAnimators(): parents before children, map order otherwise -----
+  // Counting sort on depth, reuses its buffers so it doesn't allocate once 
+  // the animator count has peaked
+  void sortAnimators() {
+    ANI_TRACE_SCOPE("Ani::sort", this);
+    const size_t n = animators_.size();
+    order_.clear();
+    depths_.clear();
+    
+    for (animatorMap::iterator it = animators_.begin(); it != animators_.end(); ++it) {
+      uintptr_t key = it->second->parentKey();
+      if (key) {
+        animatorMap::iterator parent = animators_.find(key);
+        if (parent != animators_.end() && parent->second != it->second) 
+          link(it->second, parent->second);
+      }
+    }
+    
+    size_t maxDepth = 0;
+    for (animatorMap::iterator it = animators_.begin(); it != animators_.end(); ++it) {
+      size_t depth = 0;
+      for (Animator* p = it->second->getParent(); p && depth < n; p = p->getParent()) {
+        depth++;
+      }
+      depths_.push_back(depth);
+      maxDepth = std::max(maxDepth, depth);
+    }
+    
+    counts_.assign(maxDepth + 2, 0);
+    for (size_t i = 0; i < n; i++) {
+      counts_[depths_[i] + 1]++;
+    }
+    for (size_t d = 1; d < counts_.size(); d++) {
+      counts_[d] += counts_[d - 1];
+    }
+    
+    order_.resize(n);
+    size_t i = 0;
+    for (animatorMap::iterator it = animators_.begin(); it != animators_.end(); ++it, ++i) {
+      order_[counts_[depths_[i]]++] = it->second;
+    }
+    orderDirty_ = false;
+  }
  
  protected:
-  animatorMap animators_;
+  animatorMap     animators_;
+  double          timeOrigin_;
+  
+  AnimatorContext context_;
+  EventRing       events_;
+  bool            autoDispatch_;
+  IntervalIndex   intervals_;
+  
+  std::vector<Animator*> order_;  // update order, parents first
+  std::vector<size_t>    depths_; // scratch for sortAnimators()
+  std::vector<size_t>    counts_;
+  bool                   orderDirty_;
+  bool                   updating_;
+  bool                   counting_;
+  size_t                 active_;       // after the last pass, when counting
+  
+  uint32_t               idleTicks_;    // eviction policy
+  double                 idleDuration_;
+  std::vector<Animator*> evicted_;      // due at the end of the pass
+  uint32_t               generation_;
    
-};        
+};
+
+
+/*=============================================================================
+          AniHandle: animator reference that survives eviction
+===============================================================================
+
+  Keeps what the animator was made from rather than trusting the pointer,
+  which is cached and looked up again whenever the Ani has deleted anything
+  since. An evicted animator gets recreated on the next use.
+  
+  Use:
+    AniHandle<varAnimator<float>, float*> h = ani.handle(&x);
+    h->go(1.0, 10);
+
+*/
+template <typename T>
+varAnimator<T>* aniResolve(Ani* ani, void*, T* var) {
+  return ani->mate(var);
+}
+template <typename clT, typename T, typename fnrt>
+fnctAnimator<clT, T, fnrt>* aniResolve(Ani* ani, clT* obj, fnrt(clT::*fnct)(T)) {
+  return ani->mate(obj, fnct);
+}
+
+template <typename A, typename Source, typename Object>
+class AniHandle
+{
+ public:
+  AniHandle () : ani_(0), source_(), object_(0), anim_(0), generation_(0) {}
+  AniHandle (Ani* ani, Source source, Object* object = 0) : 
+    ani_(ani),
+    source_(source),
+    object_(object),
+    anim_(0),
+    generation_(0) {}
+  
+  A* get() {
+    if (!anim_ || generation_ != ani_->generation()) {
+      anim_ = aniResolve(ani_, object_, source_);
+      generation_ = ani_->generation();
+    }
+    return anim_;
+  }
+  A* operator->() {
+    return get();
+  }
+  
+ private:
+  Ani*     ani_;
+  Source   source_;
+  Object*  object_;
+  A*       anim_;
+  uint32_t generation_;
+};
+
 } // namespace rp
\ No newline at end of file
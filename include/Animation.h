@@ -32,61 +32,188 @@
 
 #pragma once
 
+#include <stdint.h>
+#include <algorithm>
+
+#include "Ease.h"
+#include "EaseFast.h"
+#include "EaseBezier.h"
 #include "Timing.h"
+#include "Snapshot.h"
+#include "Value.h"
+#include "Callback.h"
+#include "Events.h"
+#include "Interval.h"
+#include "Trace.h"
 
 namespace rp {
 
-// ============================================================================
-
-/*
-  Simple callback class for storing and executing callbacks
-*/
-
-class callbackBase {
- public:
-  virtual void exec() = 0;
-};
+/*=============================================================================
+          SampleKernel: one easing curve over a row of progress values
+===============================================================================
 
-template <typename clT>
-class callback : public callbackBase
-{
- public:
-  callback() {}
-  callback(clT* obj, void(clT::*fnct)()) : obj_(obj), fnct_(fnct) {}
+  sample() works out the progress for a chunk of times first and then runs
+  the curve over the whole chunk. Both happen in float with selects for 
+  branches and a fixed trip count, so the loops vectorize at plain -O2:
   
-  void exec() { (obj_->*fnct_)(); }
+    * Linear, Repeat and PingPong timing are worked out inline, other 
+      timers go through their progress() per value
+    * Ease and EaseFast curves run in their EaseFast float form, 
+      c * curve(p) + b. Elastic has none and runs Ease's curve in double 
+      per value, any other method gets called through its pointer
   
-private:
-  clT* obj_;
-  void(clT::*fnct_)();
-};
+  Values are within float rounding of what update() would set.
 
-template <typename clT, typename T1>
-class callbackA1 : public callbackBase
+*/
+template <typename T>
+struct SampleKernel
 {
- public:
-  callbackA1() {}
-  callbackA1(clT* obj, void(clT::*fnct)(T1), T1 arg) 
-    : obj_(obj), arg_(arg), fnct_(fnct) {}
+  enum { Chunk = 64 };
+  
+  typedef T (*Method)(double t, T b, T c, double d);
+  typedef void (*Row)(const float* p, size_t n, T b, T c, T* out);
+  
+  // ------ progress(): timing for up to a chunk of times, p holds a chunk ----
+  // Progress before the start is 0, every curve returns b there
+  static void progress(TimingKind::Type timing, const double* t, size_t n, 
+                       double start, float scale, float span, float* p) 
+  {
+    float x[Chunk];
+    if (n == size_t(Chunk)) {
+      for (int i = 0; i < Chunk; i++) {
+        x[i] = float(t[i] - start) * scale;
+      }
+    } else {
+      for (size_t i = 0; i < size_t(Chunk); i++) {
+        x[i] = (i < n) ? float(t[i] - start) * scale : 0.0f;
+      }
+    }
+    
+    // past 2^23 a float has no fraction left, and the int cast must not wrap
+    switch (timing) {
+      case TimingKind::Repeat:
+        for (int i = 0; i < Chunk; i++) {
+          const float y = clamp(x[i], 8388608.0f);
+          p[i] = EaseFast::select(y >= span, 1.0f, y - float(int(y)));
+        }
+        break;
+      case TimingKind::PingPong:
+        for (int i = 0; i < Chunk; i++) {
+          const float y = clamp(x[i], 8388608.0f);
+          const float h = 0.5f * y;
+          const float v = 2.0f * (h - float(int(h)));
+          p[i] = EaseFast::select(y >= span, 0.0f, 
+                                  EaseFast::select(v < 1.0f, v, 2.0f - v));
+        }
+        break;
+      default:
+        for (int i = 0; i < Chunk; i++) {
+          p[i] = clamp(x[i], 1.0f);
+        }
+        break;
+    }
+  }
+  
+  // std::min/max on floats are branches at -O2, selects aren't
+  static float clamp(float x, float hi) {
+    return EaseFast::select(x > 0.0f, EaseFast::select(x < hi, x, hi), 0.0f);
+  }
+  
+  // ------ Rows: n values out of a chunk of progress -------------------------
+  template <float (*Curve)(float x)>
+  static void fast(const float* p, size_t n, T b, T c, T* out) {
+    float e[Chunk];
+    for (int i = 0; i < Chunk; i++) {
+      e[i] = Curve(p[i]);
+    }
+    if (n == size_t(Chunk)) {
+      for (int i = 0; i < Chunk; i++) {
+        out[i] = c * e[i] + b;
+      }
+    } else {
+      for (size_t i = 0; i < n; i++) {
+        out[i] = c * e[i] + b;
+      }
+    }
+  }
+  
+  // Curves without a float form, called per value
+  template <T (*Curve)(double t, T b, T c, double d)>
+  static void row(const float* p, size_t n, T b, T c, T* out) {
+    for (size_t i = 0; i < n; i++) {
+      out[i] = Curve(p[i], b, c, 1);
+    }
+  }
   
-  void exec() { (obj_->*fnct_)(arg_); }
+  // ------ find(): kernel for an easing method, 0 if it has none -------------
+  static Row find(Method m) {
+    EaseKind::Type kind = EaseTable<T>::find(m);
+    if (kind != EaseKind::Count) 
+      return rows[kind];
+    for (int i = 0; i < FastCount; i++) {
+      if (fastMethods[i] == m) return fastRows[i];
+    }
+    return 0;
+  }
   
-private:
-  clT* obj_;
-  T1 arg_;
-  void(clT::*fnct_)(T1);
+  enum { FastCount = 9 };
+  static const Row    rows[EaseKind::Count];
+  static const Method fastMethods[FastCount];
+  static const Row    fastRows[FastCount];
+};
+
+#define ANI_SAMPLE_FAST(curve) &SampleKernel<T>::template fast<&EaseFast::curve>
+#define ANI_SAMPLE_ROW(curve)  &SampleKernel<T>::template row<&Ease::curve<T> >
+
+// In EaseKind order
+template <typename T>
+const typename SampleKernel<T>::Row SampleKernel<T>::rows[EaseKind::Count] = {
+  ANI_SAMPLE_FAST(linear),   ANI_SAMPLE_FAST(linear),    
+  ANI_SAMPLE_FAST(linear),   ANI_SAMPLE_FAST(linear),
+  ANI_SAMPLE_FAST(inSine),   ANI_SAMPLE_FAST(outSine),   ANI_SAMPLE_FAST(inOutSine),
+  ANI_SAMPLE_FAST(inBack),   ANI_SAMPLE_FAST(outBack),   ANI_SAMPLE_FAST(inOutBack),
+  ANI_SAMPLE_FAST(inCirc),   ANI_SAMPLE_FAST(outCirc),   ANI_SAMPLE_FAST(inOutCirc),
+  ANI_SAMPLE_FAST(inCubic),  ANI_SAMPLE_FAST(outCubic),  ANI_SAMPLE_FAST(inOutCubic),
+  ANI_SAMPLE_FAST(inExpo),   ANI_SAMPLE_FAST(outExpo),   ANI_SAMPLE_FAST(inOutExpo),
+  ANI_SAMPLE_FAST(inQuad),   ANI_SAMPLE_FAST(outQuad),   ANI_SAMPLE_FAST(inOutQuad),
+  ANI_SAMPLE_FAST(inQuart),  ANI_SAMPLE_FAST(outQuart),  ANI_SAMPLE_FAST(inOutQuart),
+  ANI_SAMPLE_FAST(inQuint),  ANI_SAMPLE_FAST(outQuint),  ANI_SAMPLE_FAST(inOutQuint),
+  ANI_SAMPLE_FAST(inBounce), ANI_SAMPLE_FAST(outBounce), ANI_SAMPLE_FAST(inOutBounce),
+  ANI_SAMPLE_ROW(InElastic), ANI_SAMPLE_ROW(OutElastic), ANI_SAMPLE_ROW(InOutElastic)
 };
 
+template <typename T>
+const typename SampleKernel<T>::Method SampleKernel<T>::fastMethods[FastCount] = {
+  &EaseFast::InSine<T>, &EaseFast::OutSine<T>, &EaseFast::InOutSine<T>,
+  &EaseFast::InExpo<T>, &EaseFast::OutExpo<T>, &EaseFast::InOutExpo<T>,
+  &EaseFast::InCirc<T>, &EaseFast::OutCirc<T>, &EaseFast::InOutCirc<T>
+};
+
+template <typename T>
+const typename SampleKernel<T>::Row SampleKernel<T>::fastRows[FastCount] = {
+  ANI_SAMPLE_FAST(inSine), ANI_SAMPLE_FAST(outSine), ANI_SAMPLE_FAST(inOutSine),
+  ANI_SAMPLE_FAST(inExpo), ANI_SAMPLE_FAST(outExpo), ANI_SAMPLE_FAST(inOutExpo),
+  ANI_SAMPLE_FAST(inCirc), ANI_SAMPLE_FAST(outCirc), ANI_SAMPLE_FAST(inOutCirc)
+};
+
+#undef ANI_SAMPLE_FAST
+#undef ANI_SAMPLE_ROW
+
 
 /*=============================================================================
           AnimationBase: base class for animations (duh.)
 =============================================================================*/
 
 template <typename T>
-class AnimationBase 
+class AnimationBase : public Pooled
 {
  public:
-  AnimationBase () {}
+  AnimationBase () : started_(false), finished_(false), delaying_(false),
+                     timeMethod_(0),
+                     doCallbackFinish_(false),
+                     doCallbackStep_(false),
+                     doCallbackStart_(false),
+                     events_(0), eventId_(0), settle_(0), interval_(0) {}
   AnimationBase (double duration, 
                  T finalVal, 
                  T (*easing)(double t, T b, T c, double d),
@@ -96,7 +223,8 @@ class AnimationBase
               easingMethod_(easing), timeMethod_(timer), 
               doCallbackFinish_(false),
               doCallbackStep_(false),
-              doCallbackStart_(false) {}
+              doCallbackStart_(false),
+              events_(0), eventId_(0), settle_(0), interval_(0) {}
   
   virtual ~AnimationBase() { destroy(); }
   
@@ -105,6 +233,8 @@ class AnimationBase
     return this;
   }
   AnimationBase<T>* setTimeMethod(TimeBase* timer) { 
+    if (timer != timeMethod_) 
+      delete timeMethod_;
     timeMethod_ = timer; 
     return this; 
   }
@@ -145,8 +275,194 @@ class AnimationBase
     return this;
   }
   
+  // ------ Deferred events ---------------------------------------------------
+  AnimationBase<T>* setEventRing(EventRing* events) {
+    events_ = events;
+    return this;
+  }
+  AnimationBase<T>* setEventId(uint32_t id) {
+    eventId_ = id;
+    return this;
+  }
+  uint32_t getEventId() {
+    return eventId_;
+  }
+  
+  // ------ Settling, see Ani::setSettle() ------------------------------------
+  AnimationBase<T>* setSettle(double epsilon) {
+    settle_ = float(epsilon);
+    return this;
+  }
+  
+  // ------ Swap in a finish callback, returns the previous one or 0 ----------
+  callbackBase* swapCallbackFinish(callbackBase* cb) {
+    callbackBase* prev = doCallbackFinish_ ? callbackFinish_ : 0;
+    doCallbackFinish_ = (cb != 0);
+    callbackFinish_ = cb;
+    return prev;
+  }
+  
   virtual void update(const double ttime) = 0;
   
+  // ------ Schedule, from is when the animation comes up in its queue --------
+  double scheduledStart(const double from) const {
+    if (started_)  return start_;
+    if (delaying_) return delayEnd_;
+    return from + delay_;
+  }
+  double scheduledEnd(const double from) const {
+    double span = timeMethod_ ? timeMethod_->span() : 1;
+    if (span == HUGE_VAL) 
+      return HUGE_VAL;
+    return scheduledStart(from) + duration_ * span;
+  }
+  bool hasBegun() const {
+    return started_ || delaying_;
+  }
+  
+  // ------ sample(): values at n times, without touching any state -----------
+  // Animations that haven't started are sampled as if they came up at from,
+  // or at their interval index estimate when they have one
+  void sample(const double* times, size_t n, T* out, const double from) const {
+    sample(times, n, out, from, SampleKernel<T>::find(easingMethod_));
+  }
+  
+  // With the kernel for the easing method already looked up, 0 for none
+  void sample(const double* times, size_t n, T* out, const double from, 
+              typename SampleKernel<T>::Row kernel) const 
+  {
+    typedef SampleKernel<T> Kernel;
+    const T      b = started_ ? beginning_ : sampleBeginning();
+    const T      c = started_ ? change_ : EaseTraits<T>::change(b, final_val_);
+    const double start = (hasBegun() || !interval_) ? scheduledStart(from) 
+                                                    : interval_->start;
+    const uint8_t timing = timeMethod_ ? timeMethod_->kind() : uint8_t(TimingKind::Linear);
+    const float   span   = timeMethod_ ? float(timeMethod_->span()) : 1.0f;
+    const float   scale  = float(1.0 / duration_);
+    float         p[Kernel::Chunk];
+    
+    for (size_t i0 = 0; i0 < n; i0 += size_t(Kernel::Chunk)) {
+      const size_t m = std::min(n - i0, size_t(Kernel::Chunk));
+      const double* t = times + i0;
+      T* row = out + i0;
+      
+      if (timing < TimingKind::Count) {
+        Kernel::progress(TimingKind::Type(timing), t, m, start, scale, span, p);
+      } else {
+        for (size_t i = 0; i < m; i++) {
+          bool finished = false;
+          p[i] = float(timeMethod_->progress(t[i] > start ? t[i] : start, start, 
+                                             duration_, finished));
+        }
+      }
+      
+      if (kernel) {
+        kernel(p, m, b, c, row);
+      } else {
+        for (size_t i = 0; i < m; i++) {
+          row[i] = easingMethod_(p[i], b, c, 1);
+        }
+      }
+      for (size_t i = 0; i < m; i++) {
+        EaseTraits<T>::normalize(row[i]);
+      }
+    }
+  }
+  
+  T (*getEasingMethod() const)(double t, T b, T c, double d) {
+    return easingMethod_;
+  }
+  
+  // ------ Node in the Ani's interval index, 0 when not indexed --------------
+  IntervalNode* getInterval() {
+    return interval_;
+  }
+  void setInterval(IntervalNode* node) {
+    interval_ = node;
+  }
+  
+  // ------ Snapshot support --------------------------------------------------
+  void save(SnapshotWriter& out) {
+    uint8_t flags = (started_          ? 0x01 : 0) | 
+                    (finished_         ? 0x02 : 0) | 
+                    (delaying_         ? 0x04 : 0) |
+                    (doCallbackStart_  ? 0x08 : 0) | 
+                    (doCallbackStep_   ? 0x10 : 0) | 
+                    (doCallbackFinish_ ? 0x20 : 0);
+    out.write(flags);
+    out.write(duration_);
+    out.write(start_);
+    out.write(delay_);
+    out.write(delayEnd_);
+    out.write(beginning_);
+    out.write(final_val_);
+    out.write(change_);
+    out.write(eventId_);
+    
+    // ------ Easing by EaseKind, bezier curves by their control points ------
+    uint8_t ease = uint8_t(EaseTable<T>::find(easingMethod_));
+    int slot = (ease == EaseKind::Count) ? EaseBezier::slotOf<T>(easingMethod_) : -1;
+    if (slot >= 0) 
+      ease = BezierEase;
+    out.write(ease);
+    if (slot >= 0) {
+      const CubicBezier& c = EaseBezier::curve(slot);
+      out.write(c.x1); out.write(c.y1); out.write(c.x2); out.write(c.y2);
+    }
+    
+    uint8_t timing = timeMethod_ ? timeMethod_->kind() : uint8_t(TimingKind::Count);
+    out.write(timing);
+    if (timeMethod_) 
+      timeMethod_->save(out);
+  }
+  
+  bool restore(SnapshotReader& in, SnapshotResolver& resolver) {
+    uint8_t flags = 0, ease = 0, timing = 0;
+    in.read(flags);
+    in.read(duration_);
+    in.read(start_);
+    in.read(delay_);
+    in.read(delayEnd_);
+    in.read(beginning_);
+    in.read(final_val_);
+    in.read(change_);
+    in.read(eventId_);
+    started_  = (flags & 0x01) != 0;
+    finished_ = (flags & 0x02) != 0;
+    delaying_ = (flags & 0x04) != 0;
+    
+    in.read(ease);
+    easingMethod_ = Ease::NoneLinear;
+    if (ease < EaseKind::Count) {
+      easingMethod_ = EaseTable<T>::method(EaseKind::Type(ease));
+    } else if (ease == BezierEase) {
+      double x1 = 0, y1 = 0, x2 = 1, y2 = 1;
+      in.read(x1); in.read(y1); in.read(x2); in.read(y2);
+      T (*m)(double, T, T, double) = EaseBezier::method<T>(x1, y1, x2, y2);
+      if (m) easingMethod_ = m;
+    }
+    
+    in.read(timing);
+    setTimeMethod(Timing::create(timing));
+    if (timing < TimingKind::Count) 
+      timeMethod_->restore(in);
+    
+    // ------ Callbacks get rebuilt by the resolver ---------------------------
+    if (flags & 0x08) 
+      restoreCallback(doCallbackStart_, callbackStart_, resolver, EventKind::Start);
+    if (flags & 0x10) 
+      restoreCallback(doCallbackStep_, callbackStep_, resolver, EventKind::Step);
+    if (flags & 0x20) 
+      restoreCallback(doCallbackFinish_, callbackFinish_, resolver, EventKind::Finish);
+    return in.ok();
+  }
+  
+  // ------ shift(): move the absolute times it's picked up so far ----------
+  void shift(const double offset) {
+    if (started_)  start_    += offset;
+    if (delaying_) delayEnd_ += offset;
+  }
+  
   bool isComplete() { 
    return finished_;
   }
@@ -155,17 +471,37 @@ class AnimationBase
  protected:
   void callbackFinish() {
    if (finished_) { // only execute if we are finishing the animation
-     if (doCallbackFinish_) 
-       callbackFinish_->exec();
+     if (doCallbackFinish_) {
+       // one shot, hand it over before it runs
+       callbackBase* cb = swapCallbackFinish(0);
+       if (events_) {
+         events_->push(cb, eventId_, EventKind::Finish);
+       } else {
+         ANI_TRACE_SCOPE("callback", cb);
+         cb->fire();
+       }
+     } else if (events_ && eventId_) {
+       events_->push(0, eventId_, EventKind::Finish);
+     }
    }
   };
   void callbackStart() {
-    if (doCallbackStart_) 
+    if (events_) {
+      if (doCallbackStart_ || eventId_)
+        events_->push(doCallbackStart_ ? callbackStart_ : 0, eventId_, EventKind::Start);
+    } else if (doCallbackStart_) {
+      ANI_TRACE_SCOPE("callback", callbackStart_);
       callbackStart_->exec();
+    }
   }
   void callbackStep() {
-    if (doCallbackStep_)
+    if (events_) {
+      if (doCallbackStep_ || eventId_)
+        events_->push(doCallbackStep_ ? callbackStep_ : 0, eventId_, EventKind::Step);
+    } else if (doCallbackStep_) {
+      ANI_TRACE_SCOPE("callback", callbackStep_);
       callbackStep_->exec();
+    }
   }
   
   /*
@@ -190,24 +526,60 @@ class AnimationBase
 
   // ------ Call easing and time methods --------------------------------------
   T updateVar(const double ttime) {
-   return easingMethod_(
-             (*timeMethod_)(ttime, start_, duration_, finished_),
-             beginning_, 
-             change_,
-             1);
+   ANI_TRACE_SCOPE("easing", this);
+   T value = easingMethod_(
+               (*timeMethod_)(ttime, start_, duration_, finished_),
+               beginning_, 
+               change_,
+               1);
+   EaseTraits<T>::normalize(value);
+   return value;
+  }
+  
+  // ------ settle(): finish early once a step lands within epsilon -----------
+  // The value has to be that close to the final one and have moved less 
+  // than that since the last step, so curves passing through the final 
+  // value on their way (Back, Elastic) carry on. One-shot timings only.
+  void settle(T& value, const T& previous) {
+    if (timeMethod_->kind() != TimingKind::Linear) 
+      return;
+    if (ValueSettle<T>::within(value, final_val_, settle_) && 
+        ValueSettle<T>::within(value, previous, settle_)) 
+    {
+      value = final_val_;
+      finished_ = true;
+    }
+  }
+  
+  // ------ Value the animation would start from -----------------------------
+  virtual T sampleBeginning() const {
+    return beginning_;
+  }
+  
+  void restoreCallback(bool& doCallback, callbackBase*& cb, 
+                       SnapshotResolver& resolver, EventKind::Type kind) {
+    if (doCallback) 
+      cb->release();
+    cb = resolver.callback(eventId_, kind);
+    doCallback = (cb != 0);
   }
   
   void destroy() {
+    delete timeMethod_;
+    timeMethod_ = 0;
     if (doCallbackFinish_) 
-      delete callbackFinish_;
+      callbackFinish_->release();
+    // Deferred records may still point at these
     if (doCallbackStart_) 
-      delete callbackStart_;
+      events_ ? events_->retire(callbackStart_) : callbackStart_->release();
     if (doCallbackStep_) 
-      delete callbackStep_;
+      events_ ? events_->retire(callbackStep_) : callbackStep_->release();
   }
 
 // ====== Protected properties ================================================
  protected:
+  enum { BezierEase = 0xfe }; // stored easing for EaseBezier curves
+  
   bool    started_;
   bool    finished_;
   bool    delaying_;
@@ -232,6 +604,13 @@ class AnimationBase
   callbackBase* callbackStep_;
   bool          doCallbackStart_;
   callbackBase* callbackStart_;
+  
+  // ------ Deferred events ---------------------------------------------------
+  EventRing*    events_;
+  uint32_t      eventId_;
+  float         settle_;  // 0 runs to the end
+  
+  IntervalNode* interval_;
 
 };
 
@@ -256,7 +635,7 @@ class Animation : public AnimationBase<T>
   
   Animation<T>* setFinalValue(T finalVal) { 
    this->final_val_ = finalVal; 
-   this->change_ = finalVal - *var_;
+   this->change_ = EaseTraits<T>::change(*var_, finalVal);
    return this;
   }
   
@@ -270,15 +649,23 @@ class Animation : public AnimationBase<T>
      AnimationBase<T>::callbackStart();
      this->started_ = true;
      this->start_ = ttime;
-     this->change_ = this->final_val_ - *var_;
+     this->change_ = EaseTraits<T>::change(*var_, this->final_val_);
      this->beginning_ = *var_;
     }
         
-    *var_ = this->updateVar(ttime);
+    T value = this->updateVar(ttime);
+    if (this->settle_ > 0 && !this->finished_) 
+      this->settle(value, *var_);
+    *var_ = value;
 
     AnimationBase<T>::callbackStep();
     AnimationBase<T>::callbackFinish();
   }
+  
+ protected:
+  T sampleBeginning() const {
+    return *var_;
+  }
 
  private:  
   T* var_;
@@ -293,6 +680,7 @@ class fnctAnimation : public AnimationBase<T>
  public:
   // ------ Buildable animation constructor -----------------------------------
   fnctAnimation () {}
+  fnctAnimation (clT* obj, fnrt(clT::*fnct)(T)) : fnct_(fnct), obj_(obj) {}
   
   // ------ Mammoth singular animation constructor ----------------------------
   fnctAnimation (clT* obj,
@@ -312,7 +700,7 @@ class fnctAnimation : public AnimationBase<T>
   
   fnctAnimation<clT, T, fnrt>* setFinalValue(T finalVal) { 
    this->final_val_ = finalVal;
-   this->change_ = finalVal - this->beginning_;
+   this->change_ = EaseTraits<T>::change(this->beginning_, finalVal);
    return this;
   }
   
@@ -328,8 +716,14 @@ class fnctAnimation : public AnimationBase<T>
        this->started_ = true;
        this->start_ = ttime;
        // this->change_ = this->final_val_ - this->beginning_;
+       last_ = this->beginning_;
      }
-     (obj_->*fnct_)(this->updateVar(ttime));
+     T value = this->updateVar(ttime);
+     if (this->settle_ > 0 && !this->finished_) 
+       this->settle(value, last_);
+     last_ = value;
+     
+     (obj_->*fnct_)(value);
 
      AnimationBase<T>::callbackStep();
      AnimationBase<T>::callbackFinish();
@@ -338,7 +732,41 @@ class fnctAnimation : public AnimationBase<T>
  private:  
   fnrt(clT::*fnct_)(T);
   clT*                                  obj_;
+  T                                     last_;  // value set by the last step
 };
 
+/*=============================================================================
+          sampleAnimations(): many animations at many times
+===============================================================================
+
+  Fills out as a count x n matrix, row r holds anims[r] at every time. 
+  Nothing gets updated, timers keep their counters and callbacks don't 
+  run, so it's safe on live animations:
+  
+    sampleAnimations(&anims[0], anims.size(), times, 64, &preview[0], now);
+  
+  Timing and curves run in float over chunks of 64 times, see SampleKernel.
+  64 samples of 10k animations are 2.5 MB of output: with AVX (-march=native)
+  they take about as long as one update() pass over them, with plain SSE2 
+  and -O2 about twice that, most of it spent writing the output. Elastic, 
+  custom curves and custom timers fall back to a call per value.
+
+*/
+template <typename T>
+void sampleAnimations(AnimationBase<T>* const* anims, size_t count,
+                      const double* times, size_t n, T* out, const double from) 
+{
+  // Neighbours mostly share a curve, so the kernel lookup is reused
+  typename SampleKernel<T>::Method method = 0;
+  typename SampleKernel<T>::Row    kernel = 0;
+  for (size_t r = 0; r < count; r++) {
+    if (r == 0 || anims[r]->getEasingMethod() != method) {
+      method = anims[r]->getEasingMethod();
+      kernel = SampleKernel<T>::find(method);
+    }
+    anims[r]->sample(times, n, out + r * n, from, kernel);
+  }
+}
+
 } // namespace rp
 
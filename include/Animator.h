@@ -31,11 +31,16 @@
 //  ------------------------------------------------------------------------ // 
 #pragma once
 
+#include <stdint.h>
 #include <deque>
 
+#include "Pool.h"
 #include "Timing.h"
 #include "Ease.h"
+#include "Snapshot.h"
+#include "Interval.h"
 #include "Animation.h"
+#include "Trace.h"
 #include "Ani.h"
 
 namespace rp {
@@ -50,12 +55,122 @@ using std::deque;
   This base class is purely for storage within rp::Ani
 
 */
-class Animator
+/*
+  What Ani needs to tell apart when two kinds share a key, like plain and
+  relative animators of the same variable
+*/
+struct AnimatorKind
+{
+  enum Type {
+    Other,
+    Var,
+    Relative
+  };
+};
+
+/*
+  Shared state an Ani hands to each of its animators
+*/
+struct AnimatorContext
+{
+  AnimatorContext () : events(0), intervals(0), indexing(false), now(0), settle(0) {}
+  
+  EventRing*     events;    // deferred callbacks, 0 runs them in place
+  IntervalIndex* intervals; // schedule of queued animations
+  bool           indexing;  // whether new animations go into intervals
+  double         now;       // time of the current or last update pass
+  double         settle;    // epsilon for finishing early, 0 for never
+};
+
+class Animator : public Pooled
 {
 public:
-  Animator () {}
+  Animator () : 
+    context_(0), 
+    parent_(0), 
+    children_(0), 
+    key_(0), 
+    pinned_(false), 
+    idleTicks_(0), 
+    idleSince_(0) {}
+  virtual ~Animator () {}
   virtual void update(const double time) {}
+  virtual void rebase(const double origin) {}
+  virtual void shift(const double offset) {}   // moves stored absolute times
   virtual void destroy() {}
+  
+  // ------ Snapshot support, false when an animator can't be stored ---------
+  virtual bool save(SnapshotWriter& out, SnapshotResolver& resolver) { return false; }
+  virtual bool restore(SnapshotReader& in, SnapshotResolver& resolver) { return false; }
+  
+  void setContext(AnimatorContext* context) {
+    context_ = context;
+  }
+  
+  // ------ Hierarchy, parents update before their children ------------------
+  void setParent(Animator* parent) {
+    if (parent_) 
+      parent_->children_--;
+    parent_ = parent;
+    if (parent_) 
+      parent_->children_++;
+  }
+  Animator* getParent() {
+    return parent_;
+  }
+  // Key of the animator this one reads from, Ani links it up when non zero
+  virtual uintptr_t parentKey() { return 0; }
+  
+  virtual uint8_t kind() { return AnimatorKind::Other; }
+  
+  // ------ Animations or records currently playing ---------------------------
+  virtual size_t activeCount() { return 0; }
+  
+  // ------ Idle eviction, see Ani::setIdlePolicy() --------------------------
+  // Nothing queued, only animators Ani can recreate on demand say so
+  virtual bool isIdle() { return false; }
+  
+  Animator* pin(bool pinned = true) {
+    pinned_ = pinned;
+    return this;
+  }
+  bool isPinned() {
+    return pinned_;
+  }
+  // Linked and relative animators carry state a fresh one wouldn't have
+  bool isEvictable() {
+    return !pinned_ && !parent_ && !children_ && !parentKey() && isIdle();
+  }
+  
+  // Counts the update passes spent idle, Ani calls it after each update
+  uint32_t trackIdle(const double ttime) {
+    if (!isIdle()) 
+      return idleTicks_ = 0;
+    if (!idleTicks_) 
+      idleSince_ = ttime;
+    return ++idleTicks_;
+  }
+  double getIdleSince() {
+    return idleSince_;
+  }
+  
+  // ------ Key in the Ani's registry -----------------------------------------
+  void setKey(uintptr_t key) {
+    key_ = key;
+  }
+  uintptr_t getKey() {
+    return key_;
+  }
+  
+protected:
+  AnimatorContext* context_;
+  Animator*        parent_;
+  uint32_t         children_;
+  uintptr_t        key_;
+  
+  bool             pinned_;
+  uint32_t         idleTicks_;
+  double           idleSince_;
 };
 
 /*=============================================================================
@@ -72,12 +187,12 @@ template <typename T>
 class AnimatorImpl : public Animator
 {
 public:
-  AnimatorImpl () {}
+  AnimatorImpl () : settle_(-1) {}
   virtual ~AnimatorImpl () { destroy(); }
   
   // ------ Animation on queue push back --------------------------------------
   AnimatorImpl<T>* go() {
-    animations_.push_back(initialAnim_);
+    queue(initialAnim_);
     return this;
   }
   virtual AnimatorImpl<T>* go(double d, T f, T (*e)(double t, T b, T c, double d),
@@ -104,6 +219,15 @@ public:
     initialAnim_->setDelay(delay);
     return this;
   }
+  AnimatorImpl<T>* setEventId(uint32_t id) {
+    initialAnim_->setEventId(id);
+    return this;
+  }
+  // Overrides Ani::setSettle() for animations queued afterwards, -1 resets
+  AnimatorImpl<T>* setSettle(double epsilon) {
+    settle_ = epsilon;
+    return this;
+  }
   
   // ------ Callbacks ---------------------------------------------------------
   template <typename clT>
@@ -132,10 +256,23 @@ public:
   bool isAnimating() {
     return !animations_.empty();
   }
+  bool isIdle() {
+    return animations_.empty();
+  }
+  size_t activeCount() {
+    return animations_.size();
+  }
   AnimationBase<T>* getCurrentAnimation() { 
     if (!animations_.empty()) {
       return animations_.front();
     }
+    return 0;
+  }
+  AnimationBase<T>* getLastAnimation() { 
+    if (!animations_.empty()) {
+      return animations_.back();
+    }
+    return 0;
   }
   
   // ------ Buttons -----------------------------------------------------------
@@ -148,21 +285,68 @@ public:
     return this;
   }
   AnimatorImpl<T>* stop() {
-    if (!animations_.empty()) 
-      animations_.clear();
+    destroy();
+    animations_.clear();
     return this;
   }
   AnimatorImpl<T>* reverse() {}
   
+  // ------ Snapshot support --------------------------------------------------
+  bool save(SnapshotWriter& out, SnapshotResolver& resolver) {
+    out.write(paused_);
+    out.write(uint32_t(animations_.size()));
+    for ( typename animationQueue::iterator it = animations_.begin(); 
+      it != animations_.end(); ++it )
+    {
+      (*it)->save(out);
+    }
+    return true;
+  }
+  bool restore(SnapshotReader& in, SnapshotResolver& resolver) {
+    uint32_t count = 0;
+    in.read(paused_);
+    in.read(count);
+    stop();
+    
+    for (uint32_t i = 0; i < count && in.ok(); i++) {
+      AnimationBase<T>* anim = makeAnimation();
+      if (!anim) 
+        return false;
+      if (!anim->restore(in, resolver)) {
+        delete anim;
+        return false;
+      }
+      queue(anim);
+    }
+    return in.ok();
+  }
+  
+  // ------ shift(): restored animations onto a clock offset from the saved one -
+  void shift(const double offset) {
+    for ( typename animationQueue::iterator it = animations_.begin(); 
+      it != animations_.end(); ++it )
+    {
+      (*it)->shift(offset);
+    }
+    if (this->context_ && this->context_->indexing) 
+      reschedule();
+  }
+  
   // ------ Updater -----------------------------------------------------------
   void update(const double ttime) {
     if (!animations_.empty()) {
-      animations_.front()->update(ttime);
+      AnimationBase<T>* front = animations_.front();
+      bool waiting = !front->hasBegun();
+      front->update(ttime);
       
       // ------ Pop animation off stack if completed --------------------------
-      if (animations_.front()->isComplete()) {
-        delete animations_.front(); // delete pointer
+      if (front->isComplete()) {
+        ANI_TRACE_SCOPE("cleanup", front);
+        unindex(front);
+        delete front;               // delete pointer
         animations_.pop_front();    // remove from stack
+      } else if (waiting && front->hasBegun() && front->getInterval()) {
+        reschedule();               // the real start is known now
       }
     }
   }
@@ -172,18 +356,69 @@ public:
     paused_ = false;
   }
   
+  // ------ Empty animation of the right kind for restores --------------------
+  virtual AnimationBase<T>* makeAnimation() { 
+    return 0; 
+  }
+  
+  // ------ Push an animation, picking up the Ani's shared state --------------
+  void queue(AnimationBase<T>* anim) {
+    if (settle_ >= 0) 
+      anim->setSettle(settle_);
+    if (this->context_) {
+      anim->setEventRing(this->context_->events);
+      if (settle_ < 0) 
+        anim->setSettle(this->context_->settle);
+      if (this->context_->indexing) {
+        // Comes up when the last queued one ends, or now with an empty queue
+        double from = this->context_->now;
+        if (!animations_.empty() && animations_.back()->getInterval()) 
+          from = animations_.back()->getInterval()->end;
+        anim->setInterval(this->context_->intervals->insert(
+          anim->scheduledStart(from), anim->scheduledEnd(from), this, anim));
+      }
+    }
+    animations_.push_back(anim);
+  }
+  
+  // ------ Interval index upkeep ---------------------------------------------
+  void unindex(AnimationBase<T>* anim) {
+    if (anim->getInterval()) 
+      this->context_->intervals->erase(anim->getInterval());
+    anim->setInterval(0);
+  }
+  
+  // Moves the whole queue behind an animation that started off estimate
+  void reschedule() {
+    double from = this->context_->now;
+    for ( typename animationQueue::iterator it = animations_.begin(); 
+      it != animations_.end(); ++it )
+    {
+      IntervalNode* node = (*it)->getInterval();
+      if (!node) 
+        continue;
+      this->context_->intervals->move(node, (*it)->scheduledStart(from), 
+                                            (*it)->scheduledEnd(from));
+      from = node->end;
+    }
+  }
+  
   void destroy() {
-    for ( typename std::deque<AnimationBase<T>* >::iterator it = animations_.begin(); 
+    for ( typename animationQueue::iterator it = animations_.begin(); 
       it != animations_.end(); ++it )
     {
+      unindex(*it);
       delete *it;
     }
   }
   
  protected:
-  bool paused_;
+  bool   paused_;
+  double settle_; // -1 goes with the Ani's
   
-  std::deque<AnimationBase<T>* > animations_;
+  typedef std::deque<AnimationBase<T>*, PoolAllocator<AnimationBase<T>*> > animationQueue;
+  
+  animationQueue    animations_;
   AnimationBase<T>* initialAnim_;  
 };
 
@@ -198,6 +433,8 @@ class varAnimator : public AnimatorImpl<T>
   varAnimator () {}
   varAnimator (T* var) : var_(var) { this->init(); }
   
+  uint8_t kind() { return AnimatorKind::Var; }
+  
   
   // ------ Setup new Animation -----------------------------------------------
   varAnimator<T>* anim(double duration, T finalVal) {
@@ -213,16 +450,81 @@ class varAnimator : public AnimatorImpl<T>
                   TimeBase* timeMethod = new Timing::Linear()) 
   {
     // TimeBase* timeMethod = &timeMethod;
-    this->animations_.push_back(new Animation<T>(var_, duration, finalVal,
-                                                 easingMethod, timeMethod));
+    this->queue(new Animation<T>(var_, duration, finalVal,
+                                 easingMethod, timeMethod));
     return this;
   }
   
+ protected:
+  AnimationBase<T>* makeAnimation() {
+    return new Animation<T>(var_);
+  }
+  
  protected:
   T* var_;
 };
 
 
+/*=============================================================================
+          relativeAnimator: variable animated relative to a parent variable
+===============================================================================
+
+  Animations run on a local offset, every update writes parent + offset to 
+  the variable. Ani orders it after whatever animates the parent, so the
+  result is composed with the parent's value of the same frame.
+
+*/
+template <typename T>
+class relativeAnimator : public varAnimator<T>
+{
+ public:
+  relativeAnimator (T* var, const T* parent) : 
+    varAnimator<T>(&local_),
+    target_(var),
+    parentVar_(parent),
+    local_(*var - *parent) {}
+  
+  // ------ Local offset ------------------------------------------------------
+  relativeAnimator<T>* setLocal(T local) {
+    local_ = local;
+    return this;
+  }
+  T getLocal() {
+    return local_;
+  }
+  
+  // ------ Updater -----------------------------------------------------------
+  void update(const double ttime) {
+    AnimatorImpl<T>::update(ttime);
+    *target_ = *parentVar_ + local_;
+  }
+  
+  uintptr_t parentKey() {
+    return reinterpret_cast<uintptr_t>(parentVar_);
+  }
+  uint8_t kind() { return AnimatorKind::Relative; }
+  
+  // ------ Snapshot support, the local offset goes first --------------------
+  bool save(SnapshotWriter& out, SnapshotResolver& resolver) {
+    out.write(local_);
+    return AnimatorImpl<T>::save(out, resolver);
+  }
+  bool restore(SnapshotReader& in, SnapshotResolver& resolver) {
+    T local = local_;
+    in.read(local);
+    if (!in.ok()) 
+      return false;
+    local_ = local;
+    return AnimatorImpl<T>::restore(in, resolver);
+  }
+  
+ protected:
+  T*       target_;
+  const T* parentVar_;
+  T        local_;
+};
+
+
 /*=============================================================================
           fnctAnimator: Animation Function container
 =============================================================================*/
@@ -243,10 +545,14 @@ class fnctAnimator : public AnimatorImpl<T>
     return this;
   }
   
+ protected:
+  AnimationBase<T>* makeAnimation() {
+    return new fnctAnimation<clT, T, fnrt>(obj_, fnct_);
+  }
+  
  protected:  
   fnrt(clT::*fnct_)(T);
   clT*                                        obj_;
-  std::deque<fnctAnimation<clT, T, fnrt>* >   animations_;
 };
 
 
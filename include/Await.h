@@ -0,0 +1,153 @@
+//  ------------------------------------------------------------------------ // 
+//  ===== Await.h ========================================================== // 
+//  ------------------------------------------------------------------------ // 
+//   Created:        Kevin Webster                                           // 
+//   Date:           26.10.19                                                // 
+//   Copyright (c)   2010 All rights reserved.                               // 
+//  ------------------------------------------------------------------------ // 
+//  Redistribution and use in source and binary forms, with or without       // 
+//  modification, are permitted provided that the following conditions       // 
+//  are met:                                                                 // 
+//                                                                           // 
+//     * Redistributions of source code must retain the above copyright      // 
+//       notice, this list of conditions and the following disclaimer.       // 
+//     * Redistributions in binary form must reproduce the above copyright   // 
+//       notice, this list of conditions and the following disclaimer in     // 
+//       the documentation and/or other materials provided with the          // 
+//       distribution.                                                       // 
+//     * Stealing is also kinda lame.                                        // 
+//                                                                           // 
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS      // 
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT        // 
+//  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR    // 
+//  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT     // 
+//  HOLDER OR CONTRIBUTORS BE LIABLEFOR ANY DIRECT, INDIRECT, INCIDENTAL,    // 
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED // 
+//  TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR   // 
+//  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF   // 
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING     // 
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS       // 
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.             // 
+//  ------------------------------------------------------------------------ // 
+
+#pragma once
+
+/*
+// ====== Coroutine awaitables ================================================
+Requires C++20 coroutines, the header is empty without them.
+
+Instead of splitting a sequence over setCallbackFinish() member functions,
+a Script coroutine can wait on the last queued animation of an animator:
+
+  rp::Script intro(rp::Ani& ani, float* x, float* y) {
+    co_await rp::finished(ani.mate(x)->go(1.0, 10));
+    co_await rp::finished(ani.mate(y)->go(0.5, 20, rp::Ease::OutExpo));
+  }
+
+The coroutine is resumed from inside Ani::update(), right where the finish
+callback would have run. The awaiter lives in the coroutine frame and 
+hooks itself in as the finish callback, so waiting allocates nothing, and
+Script frames are recycled through the Pool.
+
+If the awaited animation is destroyed without finishing, the suspended 
+Script is destroyed along with it. With deferred events (Ani::deferEvents)
+Scripts resume from the dispatch instead.
+
+*/
+
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+
+#define ANI_HAS_COROUTINES 1
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <new>
+
+#include "Pool.h"
+#include "Animation.h"
+#include "Animator.h"
+
+namespace rp {
+
+/*=============================================================================
+          Script: fire and forget coroutine driven by Ani::update
+=============================================================================*/
+class Script
+{
+ public:
+  struct promise_type
+  {
+    Script get_return_object() { return Script(); }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() {}
+    void unhandled_exception() { std::terminate(); }
+    
+    static void* operator new(std::size_t size) { 
+      return Pool::allocate(size); 
+    }
+    static void operator delete(void* p, std::size_t size) { 
+      Pool::release(p, size); 
+    }
+  };
+};
+
+/*=============================================================================
+          AnimationAwaiter: resumes a coroutine when an animation finishes
+=============================================================================*/
+template <typename T>
+class AnimationAwaiter : public callbackBase
+{
+ public:
+  AnimationAwaiter (AnimationBase<T>* anim) : anim_(anim), prev_(0) {}
+  
+  bool await_ready() const { 
+    return anim_ == 0 || anim_->isComplete(); 
+  }
+  void await_suspend(std::coroutine_handle<> handle) {
+    handle_ = handle;
+    prev_ = anim_->swapCallbackFinish(this);
+  }
+  void await_resume() {}
+  
+  // ------ Finished, the animation has already let go of us -----------------
+  void fire() {
+    callbackBase* prev = prev_;
+    std::coroutine_handle<> handle = handle_;
+    if (prev) 
+      prev->fire();
+    handle.resume(); // the frame, and this, may be gone after
+  }
+  void exec() { 
+    fire(); 
+  }
+  
+  // ------ Animation destroyed while waiting ---------------------------------
+  void release() {
+    std::coroutine_handle<> handle = handle_;
+    if (prev_) 
+      prev_->release();
+    handle.destroy();
+  }
+  
+ private:
+  AnimationBase<T>*       anim_;
+  callbackBase*           prev_;
+  std::coroutine_handle<> handle_;
+};
+
+// ------ finished(): wait on the last animation queued on an animator --------
+template <typename T>
+AnimationAwaiter<T> finished(AnimatorImpl<T>* animator) {
+  return AnimationAwaiter<T>(animator->getLastAnimation());
+}
+
+template <typename T>
+AnimationAwaiter<T> finished(AnimationBase<T>* animation) {
+  return AnimationAwaiter<T>(animation);
+}
+
+} // namespace rp
+
+#endif
@@ -0,0 +1,402 @@
+//  ------------------------------------------------------------------------ // 
+//  ===== Bake.h =========================================================== // 
+//  ------------------------------------------------------------------------ // 
+//   Created:        Kevin Webster                                           // 
+//   Date:           26.10.19                                                // 
+//   Copyright (c)   2010 All rights reserved.                               // 
+//  ------------------------------------------------------------------------ // 
+//  Redistribution and use in source and binary forms, with or without       // 
+//  modification, are permitted provided that the following conditions       // 
+//  are met:                                                                 // 
+//                                                                           // 
+//     * Redistributions of source code must retain the above copyright      // 
+//       notice, this list of conditions and the following disclaimer.       // 
+//     * Redistributions in binary form must reproduce the above copyright   // 
+//       notice, this list of conditions and the following disclaimer in     // 
+//       the documentation and/or other materials provided with the          // 
+//       distribution.                                                       // 
+//     * Stealing is also kinda lame.                                        // 
+//                                                                           // 
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS      // 
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT        // 
+//  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR    // 
+//  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT     // 
+//  HOLDER OR CONTRIBUTORS BE LIABLEFOR ANY DIRECT, INDIRECT, INCIDENTAL,    // 
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED // 
+//  TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR   // 
+//  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF   // 
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING     // 
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS       // 
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.             // 
+//  ------------------------------------------------------------------------ // 
+
+#pragma once
+
+#include <stdint.h>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "Snapshot.h"
+
+namespace rp {
+
+/*
+// ====== Baked Curves ========================================================
+Long animations baked to one float per frame take a lot of memory to 
+replay. BakeWriter fits each channel of samples with cubic pieces instead,
+every piece as long as it can be while staying within the channel's 
+tolerance of every sample, and packs them into one flat buffer:
+
+  std::vector<float> frames(n);
+  anim->sample(&times[0], n, &frames[0], 0);   // or any other source
+  BakeWriter writer(60);                        // samples per time unit
+  writer.add(&frames[0], n, 1e-3f);
+  writer.write(out);                            // a SnapshotWriter
+
+The buffer is used in place, there's no decoding step. BakedCurves checks
+it and seeks by binary search, a BakeStream walks one channel forward the
+way replay does, mostly without searching at all:
+
+  BakedCurves curves;
+  curves.open(&data[0], data.size());
+  BakeStream stream(curves, 0);
+  for (...) value = stream.at(t);
+
+Between samples the pieces interpolate, the tolerance only holds at the 
+sample times. Smooth Ease curves come out at a few pieces per second, 
+Bounce needs one per bounce at least.
+
+Layout, little endian as written, 4 byte aligned:
+
+  BakeHeader                      magic "ANIB", version, channels, rate
+  BakeChannel[channels]           samples, segments, first segment, tolerance
+  BakeSegment[all segments]       first sample, 4 coefficients
+
+*/
+
+struct BakeHeader
+{
+  enum { Magic = 0x42494e41, Version = 1 }; // "ANIB"
+  
+  uint32_t magic;
+  uint32_t version;
+  uint32_t channels;
+  uint32_t reserved;
+  double   rate;     // samples per time unit
+};
+
+struct BakeChannel
+{
+  uint32_t samples;
+  uint32_t segments;
+  uint32_t first;     // index of its first segment
+  float    tolerance;
+};
+
+// Covers samples [start, next start), x = (sample - start) / length
+struct BakeSegment
+{
+  uint32_t start;
+  float    c[4];   // c0 + c1 x + c2 x^2 + c3 x^3
+  
+  float eval(float x) const {
+    return c[0] + x * (c[1] + x * (c[2] + x * c[3]));
+  }
+};
+
+
+/*=============================================================================
+          BakeWriter: fits channels and writes the buffer
+=============================================================================*/
+class BakeWriter
+{
+ public:
+  BakeWriter (double rate) : rate_(rate) {}
+  
+  // ------ add(): fit a channel, returns its index ---------------------------
+  size_t add(const float* samples, size_t n, float tolerance) {
+    BakeChannel ch;
+    ch.samples   = uint32_t(n);
+    ch.first     = uint32_t(segments_.size());
+    ch.tolerance = tolerance;
+    
+    for (size_t i = 0; i < n; ) {
+      BakeSegment seg;
+      size_t len = longest(samples + i, n - i, tolerance, seg);
+      seg.start = uint32_t(i);
+      segments_.push_back(seg);
+      i += len;
+    }
+    ch.segments = uint32_t(segments_.size() - ch.first);
+    channels_.push_back(ch);
+    return channels_.size() - 1;
+  }
+  
+  // ------ write(): the whole buffer -----------------------------------------
+  void write(SnapshotWriter& out) {
+    BakeHeader h;
+    h.magic    = BakeHeader::Magic;
+    h.version  = BakeHeader::Version;
+    h.channels = uint32_t(channels_.size());
+    h.reserved = 0;
+    h.rate     = rate_;
+    out.write(h);
+    if (!channels_.empty()) 
+      out.writeBytes(&channels_[0], channels_.size() * sizeof(BakeChannel));
+    if (!segments_.empty()) 
+      out.writeBytes(&segments_[0], segments_.size() * sizeof(BakeSegment));
+  }
+  
+  size_t segments() const {
+    return segments_.size();
+  }
+  
+ private:
+  // ------ longest(): longest piece from v[0] within tolerance ---------------
+  // Doubles the length until a fit fails, then bisects between the two.
+  // Up to four samples always fit exactly.
+  static size_t longest(const float* v, size_t n, float tolerance, BakeSegment& seg) {
+    size_t good = n < 4 ? n : 4;
+    fit(v, good, tolerance, seg);
+    
+    size_t bad = 0;
+    while (good < n) {
+      size_t len = (good * 2 < n) ? good * 2 : n;
+      BakeSegment trial;
+      if (!fit(v, len, tolerance, trial)) {
+        bad = len;
+        break;
+      }
+      seg = trial;
+      good = len;
+    }
+    while (bad && bad - good > 1) {
+      size_t len = good + (bad - good) / 2;
+      BakeSegment trial;
+      if (fit(v, len, tolerance, trial)) {
+        seg = trial;
+        good = len;
+      } else {
+        bad = len;
+      }
+    }
+    return good;
+  }
+  
+  // ------ fit(): least squares cubic over m samples, true if within tol -----
+  // Checked with the coefficients rounded to float, the way they're stored
+  static bool fit(const float* v, size_t m, float tolerance, BakeSegment& seg) {
+    const int terms = m < 4 ? int(m) : 4;
+    double a[4][5] = { { 0 } };
+    const double scale = 1.0 / m;
+    
+    for (size_t i = 0; i < m; i++) {
+      double x = i * scale, p[7];
+      p[0] = 1;
+      for (int k = 1; k < 7; k++) p[k] = p[k - 1] * x;
+      for (int r = 0; r < terms; r++) {
+        for (int c = 0; c < terms; c++) a[r][c] += p[r + c];
+        a[r][4] += p[r] * v[i];
+      }
+    }
+    
+    // Gaussian elimination with partial pivoting
+    for (int c = 0; c < terms; c++) {
+      int pivot = c;
+      for (int r = c + 1; r < terms; r++) {
+        if (std::fabs(a[r][c]) > std::fabs(a[pivot][c])) pivot = r;
+      }
+      for (int k = 0; k < 5; k++) std::swap(a[c][k], a[pivot][k]);
+      for (int r = c + 1; r < terms; r++) {
+        double f = a[r][c] / a[c][c];
+        for (int k = c; k < 5; k++) a[r][k] -= f * a[c][k];
+      }
+    }
+    double coef[4] = { 0, 0, 0, 0 };
+    for (int r = terms - 1; r >= 0; r--) {
+      double s = a[r][4];
+      for (int k = r + 1; k < terms; k++) s -= a[r][k] * coef[k];
+      coef[r] = s / a[r][r];
+    }
+    for (int k = 0; k < 4; k++) seg.c[k] = float(coef[k]);
+    
+    for (size_t i = 0; i < m; i++) {
+      if (!(std::fabs(seg.eval(float(i * scale)) - v[i]) <= tolerance)) 
+        return false;
+    }
+    return true;
+  }
+  
+ private:
+  double                   rate_;
+  std::vector<BakeChannel> channels_;
+  std::vector<BakeSegment> segments_;
+};
+
+
+/*=============================================================================
+          BakedCurves: seekable view over a written buffer
+=============================================================================*/
+class BakedCurves
+{
+ public:
+  BakedCurves () : channels_(0), segments_(0), count_(0), rate_(0) {}
+  
+  // ------ open(): checks the buffer, which has to outlive the view ----------
+  // Needs 4 byte alignment, anything from new or std::vector has it
+  bool open(const void* data, size_t size) {
+    BakeHeader h;
+    count_ = 0;
+    if (size < sizeof(h)) 
+      return false;
+    std::memcpy(&h, data, sizeof(h));
+    if (h.magic != BakeHeader::Magic || h.version != BakeHeader::Version) 
+      return false;
+    
+    const char* p = static_cast<const char*>(data);
+    size_t need = sizeof(h) + size_t(h.channels) * sizeof(BakeChannel);
+    if (size < need) 
+      return false;
+    const BakeChannel* channels = reinterpret_cast<const BakeChannel*>(p + sizeof(h));
+    
+    size_t segments = 0;
+    for (uint32_t i = 0; i < h.channels; i++) {
+      if (channels[i].first != segments || 
+          (channels[i].samples && !channels[i].segments)) 
+        return false;
+      segments += channels[i].segments;
+    }
+    if (size < need + segments * sizeof(BakeSegment)) 
+      return false;
+    
+    // Spans start at 0 and grow inside the samples, eval() divides by them
+    const BakeSegment* segs = reinterpret_cast<const BakeSegment*>(p + need);
+    for (uint32_t i = 0; i < h.channels; i++) {
+      const BakeSegment* seg = segs + channels[i].first;
+      for (uint32_t j = 0; j < channels[i].segments; j++) {
+        if (seg[j].start >= channels[i].samples || 
+            (j == 0 ? seg[j].start != 0 : seg[j].start <= seg[j - 1].start)) 
+          return false;
+      }
+    }
+    
+    channels_ = channels;
+    segments_ = segs;
+    count_    = h.channels;
+    rate_     = h.rate;
+    return true;
+  }
+  
+  // ------ Queries -----------------------------------------------------------
+  size_t channels() const { return count_; }
+  double rate() const { return rate_; }
+  const BakeChannel& channel(size_t c) const { return channels_[c]; }
+  double duration(size_t c) const { 
+    return channels_[c].samples ? (channels_[c].samples - 1) / rate_ : 0; 
+  }
+  
+  // ------ value(): one channel at a time, clamped to its samples -----------
+  float value(size_t c, double ttime) const {
+    const BakeSegment* begin = segments_ + channels_[c].first;
+    const BakeSegment* end   = begin + channels_[c].segments;
+    if (begin == end) 
+      return 0;
+    const double s = clamp(c, ttime);
+    
+    // Last segment starting at or before s
+    const BakeSegment* lo = begin;
+    size_t n = end - begin;
+    while (n > 1) {
+      size_t half = n / 2;
+      if (lo[half].start <= s) {
+        lo += half;
+        n -= half;
+      } else {
+        n = half;
+      }
+    }
+    return eval(c, lo, s);
+  }
+  
+  // ------ Used by BakeStream ------------------------------------------------
+  const BakeSegment* segments(size_t c) const { 
+    return segments_ + channels_[c].first; 
+  }
+  double clamp(size_t c, double ttime) const {
+    double s = ttime * rate_;
+    double last = channels_[c].samples ? channels_[c].samples - 1.0 : 0.0;
+    return s < 0 ? 0 : (s > last ? last : s);
+  }
+  float eval(size_t c, const BakeSegment* seg, double s) const {
+    const BakeSegment* end = segments_ + channels_[c].first + channels_[c].segments;
+    const uint32_t next = (seg + 1 < end) ? seg[1].start : channels_[c].samples;
+    return seg->eval(float((s - seg->start) / (next - seg->start)));
+  }
+  
+ private:
+  const BakeChannel* channels_;
+  const BakeSegment* segments_;
+  size_t             count_;
+  double             rate_;
+};
+
+
+/*=============================================================================
+          BakeStream: one channel, evaluated forward in time
+=============================================================================*/
+class BakeStream
+{
+ public:
+  BakeStream (const BakedCurves& curves, size_t channel) : 
+    curves_(&curves), 
+    channel_(channel),
+    begin_(curves.segments(channel)),
+    end_(begin_ + curves.channel(channel).segments),
+    seg_(begin_),
+    next_(0),
+    scale_(0) { 
+    enter(begin_); 
+  }
+  
+  // ------ at(): steps forward from the last call, seeks when going back -----
+  float at(double ttime) {
+    if (begin_ == end_) 
+      return 0;
+    const double s = curves_->clamp(channel_, ttime);
+    if (s < seg_->start) 
+      enter(begin_);
+    while (s >= next_ && seg_ + 1 < end_) {
+      enter(seg_ + 1);
+    }
+    return seg_->eval(float((s - seg_->start) * scale_));
+  }
+  
+  // ------ read(): n values from t0 every dt ---------------------------------
+  void read(double t0, double dt, float* out, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+      out[i] = at(t0 + i * dt);
+    }
+  }
+  
+ private:
+  // ------ enter(): caches where seg ends so at() doesn't look it up ---------
+  void enter(const BakeSegment* seg) {
+    seg_ = seg;
+    if (seg_ == end_) 
+      return;
+    next_  = (seg + 1 < end_) ? seg[1].start : curves_->channel(channel_).samples;
+    scale_ = 1.0 / (next_ - seg->start);
+  }
+  
+ private:
+  const BakedCurves* curves_;
+  size_t             channel_;
+  const BakeSegment* begin_;
+  const BakeSegment* end_;
+  const BakeSegment* seg_;
+  double             next_;
+  double             scale_;
+};
+
+} // namespace rp
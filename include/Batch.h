@@ -0,0 +1,198 @@
+//  ------------------------------------------------------------------------ // 
+//  ===== Batch.h ========================================================== // 
+//  ------------------------------------------------------------------------ // 
+//   Created:        Kevin Webster                                           // 
+//   Date:           26.10.19                                                // 
+//   Copyright (c)   2010 All rights reserved.                               // 
+//  ------------------------------------------------------------------------ // 
+//  Redistribution and use in source and binary forms, with or without       // 
+//  modification, are permitted provided that the following conditions       // 
+//  are met:                                                                 // 
+//                                                                           // 
+//     * Redistributions of source code must retain the above copyright      // 
+//       notice, this list of conditions and the following disclaimer.       // 
+//     * Redistributions in binary form must reproduce the above copyright   // 
+//       notice, this list of conditions and the following disclaimer in     // 
+//       the documentation and/or other materials provided with the          // 
+//       distribution.                                                       // 
+//     * Stealing is also kinda lame.                                        // 
+//                                                                           // 
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS      // 
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT        // 
+//  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR    // 
+//  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT     // 
+//  HOLDER OR CONTRIBUTORS BE LIABLEFOR ANY DIRECT, INDIRECT, INCIDENTAL,    // 
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED // 
+//  TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR   // 
+//  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF   // 
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING     // 
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS       // 
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.             // 
+//  ------------------------------------------------------------------------ // 
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "Ease.h"
+#include "Value.h"
+#include "Animator.h"
+
+namespace rp {
+
+/*=============================================================================
+          batchAnimator: one bulk setter call instead of a call per object
+===============================================================================
+
+  Animating many objects through the same setter with mate(obj, &setter) 
+  costs an animator, a virtual update and a member function call for each
+  of them. A batchAnimator keeps the objects of one setter in a flat array
+  and computes their values straight into a second one, then hands both to
+  a bulk setter in a single call per update:
+  
+    static void setX(Entity* const* objs, const float* values, size_t n) {
+      for (size_t i = 0; i < n; i++) objs[i]->x = values[i];
+    }
+    batchAnimator<Entity, float>* xs = ani.batch(&Entity::setX, setX);
+    xs->go(&entity, 1.0, 0, 10, Ease::OutCubic);
+  
+  Like prototype instances they have linear timing, no callbacks and no 
+  queue, go() on an object that's still playing adds a second one, stop() 
+  it first to retarget. The arrays keep their capacity, so a warmed up 
+  batch doesn't allocate. A finished object gets its final value in the 
+  pass it finishes in, and objects need to outlive their animation.
+
+*/
+template <typename T>
+struct BatchRecord
+{
+  double start;     // delay until the first update, absolute after it
+  double duration;
+  T      beginning;
+  T      change;
+  T    (*easing)(double t, T b, T c, double d);
+  bool   started;
+};
+
+template <typename clT, typename T>
+class batchAnimator : public Animator
+{
+ public:
+  typedef void (*BulkSetter)(clT* const* objs, const T* values, size_t n);
+  
+  batchAnimator (BulkSetter bulk) : bulk_(bulk) {}
+  
+  // ------ go(): animate obj from beginVal to finalVal -----------------------
+  batchAnimator<clT, T>* go(clT* obj, double duration, T beginVal, T finalVal,
+                            T (*easing)(double t, T b, T c, double d) = Ease::NoneLinear,
+                            double delay = 0)
+  {
+    BatchRecord<T> rec;
+    rec.start     = delay;
+    rec.duration  = duration;
+    rec.beginning = beginVal;
+    rec.change    = EaseTraits<T>::change(beginVal, finalVal);
+    rec.easing    = easing;
+    rec.started   = false;
+    objs_.push_back(obj);
+    values_.push_back(beginVal);
+    records_.push_back(rec);
+    return this;
+  }
+  
+  // ------ Buttons -----------------------------------------------------------
+  batchAnimator<clT, T>* stop(clT* obj) {
+    for (size_t i = 0; i < objs_.size(); ) {
+      if (objs_[i] == obj) {
+        remove(i);
+      } else {
+        ++i;
+      }
+    }
+    return this;
+  }
+  batchAnimator<clT, T>* stop() {
+    objs_.clear();
+    values_.clear();
+    records_.clear();
+    return this;
+  }
+  
+  // ------ Queries -----------------------------------------------------------
+  bool isAnimating() {
+    return !objs_.empty();
+  }
+  size_t size() {
+    return objs_.size();
+  }
+  size_t activeCount() {
+    return size();
+  }
+  
+  // ------ Updater -----------------------------------------------------------
+  // Delaying objects keep their begin value in the array but aren't set
+  void update(const double ttime) {
+    const size_t n = records_.size();
+    size_t live = 0, done = 0;
+    
+    for (size_t i = 0; i < n; i++) {
+      BatchRecord<T>& rec = records_[i];
+      if (!rec.started) {
+        rec.start += ttime;
+        rec.started = true;
+      }
+      if (ttime < rec.start) 
+        continue; // delaying
+      
+      const double nT = progress(rec, ttime);
+      values_[i] = rec.easing(nT >= 1.0 ? 1.0 : nT, rec.beginning, rec.change, 1);
+      EaseTraits<T>::normalize(values_[i]);
+      done += (nT >= 1.0);
+      
+      // the ones being set are moved to the front, in the order they came
+      if (live != i) 
+        swap(live, i);
+      live++;
+    }
+    if (live) 
+      bulk_(&objs_[0], &values_[0], live);
+    
+    for (size_t i = 0; done && i < live; ) {
+      if (progress(records_[i], ttime) >= 1.0) {
+        remove(i);
+        done--;
+      } else {
+        ++i;
+      }
+    }
+  }
+  
+ protected:
+  static double progress(const BatchRecord<T>& rec, const double ttime) {
+    return rec.duration > 0 ? (ttime - rec.start) / rec.duration : 1.0;
+  }
+  
+  void swap(size_t a, size_t b) {
+    std::swap(objs_[a], objs_[b]);
+    std::swap(values_[a], values_[b]);
+    std::swap(records_[a], records_[b]);
+  }
+  void remove(size_t i) {
+    const size_t last = objs_.size() - 1;
+    objs_[i]    = objs_[last];
+    values_[i]  = values_[last];
+    records_[i] = records_[last];
+    objs_.pop_back();
+    values_.pop_back();
+    records_.pop_back();
+  }
+  
+ protected:
+  BulkSetter                  bulk_;
+  std::vector<clT*>           objs_;    // what the bulk setter gets
+  std::vector<T>              values_;
+  std::vector<BatchRecord<T> > records_;
+};
+
+} // namespace rp
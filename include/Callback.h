@@ -0,0 +1,85 @@
+//  ------------------------------------------------------------------------ // 
+//  ===== Callback.h ======================================================= // 
+//  ------------------------------------------------------------------------ // 
+//   Created:        Kevin Webster                                           // 
+//   Date:           26.10.19                                                // 
+//   Copyright (c)   2010 All rights reserved.                               // 
+//  ------------------------------------------------------------------------ // 
+//  Redistribution and use in source and binary forms, with or without       // 
+//  modification, are permitted provided that the following conditions       // 
+//  are met:                                                                 // 
+//                                                                           // 
+//     * Redistributions of source code must retain the above copyright      // 
+//       notice, this list of conditions and the following disclaimer.       // 
+//     * Redistributions in binary form must reproduce the above copyright   // 
+//       notice, this list of conditions and the following disclaimer in     // 
+//       the documentation and/or other materials provided with the          // 
+//       distribution.                                                       // 
+//     * Stealing is also kinda lame.                                        // 
+//                                                                           // 
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS      // 
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT        // 
+//  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR    // 
+//  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT     // 
+//  HOLDER OR CONTRIBUTORS BE LIABLEFOR ANY DIRECT, INDIRECT, INCIDENTAL,    // 
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED // 
+//  TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR   // 
+//  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF   // 
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING     // 
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS       // 
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.             // 
+//  ------------------------------------------------------------------------ // 
+
+#pragma once
+
+#include "Pool.h"
+
+namespace rp {
+
+// ============================================================================
+
+/*
+  Simple callback class for storing and executing callbacks
+*/
+
+class callbackBase : public Pooled {
+ public:
+  virtual ~callbackBase() {}
+  virtual void exec() = 0;
+  // Called instead of delete when the owning animation goes away
+  virtual void release() { delete this; }
+  // One shot use, finish callbacks are handed over when they run
+  virtual void fire() { exec(); release(); }
+};
+
+template <typename clT>
+class callback : public callbackBase
+{
+ public:
+  callback() {}
+  callback(clT* obj, void(clT::*fnct)()) : obj_(obj), fnct_(fnct) {}
+  
+  void exec() { (obj_->*fnct_)(); }
+  
+private:
+  clT* obj_;
+  void(clT::*fnct_)();
+};
+
+template <typename clT, typename T1>
+class callbackA1 : public callbackBase
+{
+ public:
+  callbackA1() {}
+  callbackA1(clT* obj, void(clT::*fnct)(T1), T1 arg) 
+    : obj_(obj), arg_(arg), fnct_(fnct) {}
+  
+  void exec() { (obj_->*fnct_)(arg_); }
+  
+private:
+  clT* obj_;
+  T1 arg_;
+  void(clT::*fnct_)(T1);
+};
+
+} // namespace rp
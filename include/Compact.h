@@ -0,0 +1,437 @@
+//  ------------------------------------------------------------------------ // 
+//  ===== Compact.h ======================================================== // 
+//  ------------------------------------------------------------------------ // 
+//   Created:        Kevin Webster                                           // 
+//   Date:           26.10.19                                                // 
+//   Copyright (c)   2010 All rights reserved.                               // 
+//  ------------------------------------------------------------------------ // 
+//  Redistribution and use in source and binary forms, with or without       // 
+//  modification, are permitted provided that the following conditions       // 
+//  are met:                                                                 // 
+//                                                                           // 
+//     * Redistributions of source code must retain the above copyright      // 
+//       notice, this list of conditions and the following disclaimer.       // 
+//     * Redistributions in binary form must reproduce the above copyright   // 
+//       notice, this list of conditions and the following disclaimer in     // 
+//       the documentation and/or other materials provided with the          // 
+//       distribution.                                                       // 
+//     * Stealing is also kinda lame.                                        // 
+//                                                                           // 
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS      // 
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT        // 
+//  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR    // 
+//  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT     // 
+//  HOLDER OR CONTRIBUTORS BE LIABLEFOR ANY DIRECT, INDIRECT, INCIDENTAL,    // 
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED // 
+//  TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR   // 
+//  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF   // 
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING     // 
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS       // 
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.             // 
+//  ------------------------------------------------------------------------ // 
+
+#pragma once
+
+#include <stdint.h>
+#include <cmath>
+#include <vector>
+
+#include "Ease.h"
+#include "Timing.h"
+#include "Animator.h"
+
+namespace rp {
+
+/*
+// ====== Compact Animations ==================================================
+An Animation<T> carries its own flags, five doubles, a function pointer, a 
+heap allocated TimeBase and three callback slots. That's a lot of bytes for
+what is basically six numbers.
+
+CompactAnimation<T> stores the same tween as a flat record:
+
+  * times are float32 seconds relative to the owning Ani's time origin
+  * easing is an EaseKind index instead of a function pointer
+  * timing is a TimingKind packed into the flag byte with a repeat count
+  * no callbacks, use a varAnimator when you need them
+
+For T = float a record is 32 bytes, two per cache line.
+
+Accuracy:
+  Values are eased in T exactly like Animation<T>, the only difference is
+  the time base. A float has a 24 bit mantissa, so at t seconds from the 
+  origin a time is quantized to t * 2^-24:
+
+    1 minute from origin  ->  ~4 us
+    1 hour from origin    ->  ~0.2 ms
+    1 day from origin     ->  ~5 ms
+
+  The progress error is that quantization divided by the duration. Keep the
+  origin close to "now" with Ani::setTimeOrigin() in long running processes.
+  
+*/
+
+template <typename T>
+struct CompactAnimation
+{
+  enum Flags {
+    TimingMask = 0x03,
+    Started    = 1 << 2,
+    Finished   = 1 << 3
+  };
+  
+  T*       var;
+  float    start;     // holds the delay until the animation has started
+  float    duration;
+  T        beginning;
+  T        change;    // holds the final value until the animation has started
+  uint16_t repeats;   // 0 repeats forever
+  uint8_t  ease;      // EaseKind::Type
+  uint8_t  flags;     // TimingKind::Type | Flags
+  
+  TimingKind::Type timing() const {
+    return TimingKind::Type(flags & TimingMask);
+  }
+  
+  // ------ time(): normalized time for a TimingKind --------------------------
+  static float time(TimingKind::Type timing, float nT, uint16_t repeats, 
+                    bool& finished) 
+  {
+    switch (timing) {
+      case TimingKind::Repeat:
+        if (repeats && nT >= repeats) {
+          finished = true;
+          return 1.0f;
+        }
+        return nT - std::floor(nT);
+      case TimingKind::PingPong: {
+        if (repeats && nT >= 2.0f * repeats) {
+          finished = true;
+          return 0.0f;
+        }
+        float m = std::fmod(nT, 2.0f);
+        return (m > 1.0f) ? 2.0f - m : m;
+      }
+      default:
+        if (nT >= 1.0f) {
+          finished = true;
+          return 1.0f;
+        }
+        return nT;
+    }
+  }
+  
+  // ------ begin(): picks up the current value on the first update ----------
+  void begin(const float now) {
+    flags |= Started;
+    start = now + start;
+    change = change - *var;
+    beginning = *var;
+  }
+  
+  // ------ update(): returns true once the animation is done -----------------
+  bool update(const float now) {
+    if (!(flags & Started)) 
+      begin(now);
+    
+    float elapsed = now - start;
+    if (elapsed < 0) // delaying
+      return false;
+      
+    bool finished = false;
+    float nT = time(timing(), elapsed / duration, repeats, finished);
+    *var = EaseTable<T>::methods[ease](nT, beginning, change, 1);
+    
+    if (finished) 
+      flags |= Finished;
+    return finished;
+  }
+};
+
+
+/*=============================================================================
+          CompactKernel: one update loop per easing curve and timing
+===============================================================================
+
+  CompactAnimation::update() looks up the easing curve and switches on the
+  timing for every record. With a mixed workload that's an indirect call
+  and a branch the CPU can't predict. The kernels bake both into the loop
+  instead, so a bucket of records sharing a curve and timing runs straight
+  through with the curve inlined.
+
+*/
+template <typename T>
+struct CompactKernel
+{
+  typedef std::vector<CompactAnimation<T> > Records;
+  typedef void (*Run)(Records& records, const float now);
+  
+  // ------ run(): update a bucket, swapping finished records out -------------
+  template <T (*Method)(double t, T b, T c, double d), int Timing>
+  static void run(Records& records, const float now) {
+    for (size_t i = 0; i < records.size(); ) {
+      CompactAnimation<T>& rec = records[i];
+      if (!(rec.flags & CompactAnimation<T>::Started)) 
+        rec.begin(now);
+      
+      float elapsed = now - rec.start;
+      if (elapsed < 0) { // delaying
+        ++i;
+        continue;
+      }
+      
+      bool finished = false;
+      float nT = CompactAnimation<T>::time(TimingKind::Type(Timing), 
+                                           elapsed / rec.duration, 
+                                           rec.repeats, finished);
+      *rec.var = Method(nT, rec.beginning, rec.change, 1);
+      
+      if (finished) {
+        rec = records.back();
+        records.pop_back();
+      } else {
+        ++i;
+      }
+    }
+  }
+  
+  // ------ sample(): a bucket at n times, one row per record ----------------
+  // Side effect free, records that haven't started are sampled as starting 
+  // at from. Branch-free inside the row so it vectorizes with the curve.
+  template <T (*Method)(double t, T b, T c, double d), int Timing>
+  static void sample(const Records& records, const float* times, size_t n, 
+                     T* out, const float from) 
+  {
+    for (size_t r = 0; r < records.size(); r++) {
+      const CompactAnimation<T>& rec = records[r];
+      const bool  started = (rec.flags & CompactAnimation<T>::Started) != 0;
+      const T     b = started ? rec.beginning : *rec.var;
+      const T     c = started ? rec.change : rec.change - *rec.var;
+      const float start = started ? rec.start : from + rec.start;
+      const float scale = 1.0f / rec.duration;
+      T* row = out + r * n;
+      
+      for (size_t i = 0; i < n; i++) {
+        const float elapsed = times[i] - start;
+        bool finished = false;
+        float nT = CompactAnimation<T>::time(TimingKind::Type(Timing), 
+                                             (elapsed > 0 ? elapsed : 0) * scale, 
+                                             rec.repeats, finished);
+        row[i] = Method(nT, b, c, 1);
+      }
+    }
+  }
+  
+  typedef void (*Sample)(const Records& records, const float* times, size_t n, 
+                         T* out, const float from);
+  
+  static const Run    kernels[EaseKind::Count][TimingKind::Count];
+  static const Sample samplers[EaseKind::Count][TimingKind::Count];
+};
+
+#define ANI_COMPACT_KERNEL(fn, ease)                                         \
+  { &CompactKernel<T>::template fn<&Ease::ease<T>, TimingKind::Linear>,      \
+    &CompactKernel<T>::template fn<&Ease::ease<T>, TimingKind::Repeat>,      \
+    &CompactKernel<T>::template fn<&Ease::ease<T>, TimingKind::PingPong> },
+
+template <typename T>
+const typename CompactKernel<T>::Run 
+CompactKernel<T>::kernels[EaseKind::Count][TimingKind::Count] = {
+  ANI_EASE_CURVES(ANI_COMPACT_KERNEL, run)
+};
+
+template <typename T>
+const typename CompactKernel<T>::Sample 
+CompactKernel<T>::samplers[EaseKind::Count][TimingKind::Count] = {
+  ANI_EASE_CURVES(ANI_COMPACT_KERNEL, sample)
+};
+
+#undef ANI_COMPACT_KERNEL
+
+
+/*=============================================================================
+          compactAnimator: flat storage for CompactAnimations of one type
+===============================================================================
+
+  Records are independent, they don't queue per variable like varAnimator 
+  does. They're kept in one bucket per (easing curve, timing) pair, each
+  bucket is updated by its own CompactKernel. Finished records are swapped
+  out so the buckets stay dense.
+
+*/
+template <typename T>
+class compactAnimator : public Animator
+{
+ public:
+  compactAnimator () : origin_(0) { init(); }
+  compactAnimator (double origin) : origin_(origin) { init(); }
+  
+  // ------ All in one method -------------------------------------------------
+  compactAnimator<T>* go(T* var,
+                         double duration,
+                         T finalVal,
+                         EaseKind::Type easing = EaseKind::NoneLinear,
+                         TimingKind::Type timing = TimingKind::Linear,
+                         int repeats = 0,
+                         double delay = 0)
+  {
+    CompactAnimation<T> rec;
+    rec.var       = var;
+    rec.start     = float(delay);
+    rec.duration  = float(duration);
+    rec.beginning = *var;
+    rec.change    = finalVal;
+    rec.repeats   = uint16_t(repeats);
+    rec.ease      = uint8_t(easing);
+    rec.flags     = uint8_t(timing);
+    insert(rec);
+    return this;
+  }
+  
+  // ------ Buttons -----------------------------------------------------------
+  compactAnimator<T>* stop(T* var) {
+    for (size_t b = 0; b < Buckets; b++) {
+      Records& records = buckets_[b];
+      for (size_t i = 0; i < records.size(); ) {
+        if (records[i].var == var) {
+          records[i] = records.back();
+          records.pop_back();
+        } else {
+          ++i;
+        }
+      }
+    }
+    return this;
+  }
+  compactAnimator<T>* stop() {
+    for (size_t b = 0; b < Buckets; b++) {
+      buckets_[b].clear();
+    }
+    return this;
+  }
+  
+  // ------ Queries -----------------------------------------------------------
+  bool isAnimating() {
+    return size() > 0;
+  }
+  size_t size() {
+    size_t n = 0;
+    for (size_t b = 0; b < Buckets; b++) {
+      n += buckets_[b].size();
+    }
+    return n;
+  }
+  size_t activeCount() {
+    return size();
+  }
+  
+  // ------ Updater -----------------------------------------------------------
+  void update(const double ttime) {
+    const float now = float(ttime - origin_);
+    for (size_t b = 0; b < Buckets; b++) {
+      if (!buckets_[b].empty()) 
+        kernels_[b](buckets_[b], now);
+    }
+  }
+  
+  // ------ sample(): every record at n times, without updating anything -----
+  // Fills out as a size() x n matrix, vars (if given) gets the variable of 
+  // each row. Records that haven't started are sampled as starting at from.
+  size_t sample(const double* times, size_t n, T* out, const double from, 
+                T** vars = 0) 
+  {
+    times_.resize(n);
+    for (size_t i = 0; i < n; i++) {
+      times_[i] = float(times[i] - origin_);
+    }
+    const float* t = n ? &times_[0] : 0;
+    
+    size_t rows = 0;
+    for (size_t b = 0; b < Buckets; b++) {
+      const Records& records = buckets_[b];
+      if (records.empty()) 
+        continue;
+      samplers_[b](records, t, n, out + rows * n, float(from - origin_));
+      for (size_t i = 0; vars && i < records.size(); i++) {
+        vars[rows + i] = records[i].var;
+      }
+      rows += records.size();
+    }
+    return rows;
+  }
+  
+  // ------ Snapshot support, targets go through the resolver -----------------
+  bool save(SnapshotWriter& out, SnapshotResolver& resolver) {
+    out.write(origin_);
+    out.write(uint32_t(size()));
+    for (size_t b = 0; b < Buckets; b++) {
+      for (size_t i = 0; i < buckets_[b].size(); i++) {
+        CompactAnimation<T> rec = buckets_[b][i];
+        out.write(resolver.targetId(rec.var));
+        rec.var = 0;
+        out.write(rec);
+      }
+    }
+    return true;
+  }
+  bool restore(SnapshotReader& in, SnapshotResolver& resolver) {
+    uint32_t count = 0;
+    in.read(origin_);
+    in.read(count);
+    stop();
+    
+    for (uint32_t i = 0; i < count && in.ok(); i++) {
+      uint64_t id = 0;
+      CompactAnimation<T> rec;
+      in.read(id);
+      in.read(rec);
+      rec.var = static_cast<T*>(resolver.target(id));
+      if (rec.var && rec.ease < EaseKind::Count && rec.timing() < TimingKind::Count) 
+        insert(rec);
+    }
+    return in.ok();
+  }
+  
+  // ------ Started records are relative to the origin, moving it moves them --
+  void shift(const double offset) {
+    origin_ += offset;
+  }
+  
+  // ------ Move started records onto a new time origin -----------------------
+  void rebase(const double origin) {
+    const float shift = float(origin_ - origin);
+    for (size_t b = 0; b < Buckets; b++) {
+      for (size_t i = 0; i < buckets_[b].size(); i++) {
+        if (buckets_[b][i].flags & CompactAnimation<T>::Started)
+          buckets_[b][i].start += shift;
+      }
+    }
+    origin_ = origin;
+  }
+  
+ protected:
+  enum { Buckets = int(EaseKind::Count) * int(TimingKind::Count) };
+  typedef typename CompactKernel<T>::Records Records;
+  
+  void init() {
+    for (size_t b = 0; b < Buckets; b++) {
+      kernels_[b]  = CompactKernel<T>::kernels[b / TimingKind::Count]
+                                              [b % TimingKind::Count];
+      samplers_[b] = CompactKernel<T>::samplers[b / TimingKind::Count]
+                                               [b % TimingKind::Count];
+    }
+  }
+  
+  void insert(const CompactAnimation<T>& rec) {
+    buckets_[rec.ease * TimingKind::Count + rec.timing()].push_back(rec);
+  }
+  
+ protected:
+  double                            origin_;
+  Records                           buckets_[Buckets];
+  typename CompactKernel<T>::Run    kernels_[Buckets];
+  typename CompactKernel<T>::Sample samplers_[Buckets];
+  std::vector<float>                times_; // scratch for sample()
+};
+
+} // namespace rp
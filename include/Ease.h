@@ -88,49 +88,50 @@ struct Ease
   }
   
   // ------ Back --------------------------------------------------------------
+  // Overshoot math stays in double so T only needs + and * by a scalar
   template <typename T>
   static T InBack (double t, T b , T c, double d) {
-  	T s = 1.70158f;
-  	T postFix = t/=d;
-  	return c*(postFix)*t*((s+1)*t - s) + b;
+  	const double s = 1.70158;
+  	t/=d;
+  	return c*(t*t*((s+1)*t - s)) + b;
   }
   template <typename T>
   static T OutBack (double t, T b , T c, double d) {	
-  	T s = 1.70158f;
-  	return c*((t=t/d-1)*t*((s+1)*t + s) + 1) + b;
+  	const double s = 1.70158;
+  	t=t/d-1;
+  	return c*(t*t*((s+1)*t + s) + 1) + b;
   }
   template <typename T>
   static T InOutBack (double t, T b , T c, double d) {
-  	T s = 1.70158f;
-  	if ((t/=d/2) < 1) return c/2*(t*t*(((s*=(1.525f))+1)*t - s)) + b;
-  	T postFix = t-=2;
-  	return c/2*((postFix)*t*(((s*=(1.525f))+1)*t + s) + 2) + b;
+  	const double s = 1.70158*1.525;
+  	if ((t/=d/2) < 1) return c/2*(t*t*((s+1)*t - s)) + b;
+  	t-=2;
+  	return c/2*(t*t*((s+1)*t + s) + 2) + b;
   }
   // ------ Bounce ------------------------------------------------------------
-  // template <typename T>
-  // static T InBounce (double t, T b , T c, double d) {
-  //  return c - OutBounce(d-t, b, c, d) + b;
-  // }
-  // template <typename T>
-  // static T OutBounce (double t, T b , T c, double d) {
-  //  if ((t/=d) < (1/2.75f)) {
-  //    return c*(7.5625f*t*t) + b;
-  //  } else if (t < (2/2.75f)) {
-  //    T postFix = t-=(1.5f/2.75f);
-  //    return c*(7.5625f*(postFix)*t + .75f) + b;
-  //  } else if (t < (2.5/2.75)) {
-  //      T postFix = t-=(2.25f/2.75f);
-  //    return c*(7.5625f*(postFix)*t + .9375f) + b;
-  //  } else {
-  //    T postFix = t-=(2.625f/2.75f);
-  //    return c*(7.5625f*(postFix)*t + .984375f) + b;
-  //  }
-  // }
-  // template <typename T>
-  // static T InOutBounce (double t, T b , T c, double d) {
-  //  if (t < d/2) return InBounce(t*2, b, c, d) * .5f + b;
-  //  else return OutBounce(t*2-d, b, c, d) * .5f + c*.5f + b;
-  // }
+  // The four parabolas are picked by table index instead of if/else
+  static double bounce(double t) {
+  	static const double offset[4] = { 0, 1.5/2.75, 2.25/2.75, 2.625/2.75 };
+  	static const double height[4] = { 0, .75, .9375, .984375 };
+  	const int k = (t >= 1/2.75) + (t >= 2/2.75) + (t >= 2.5/2.75);
+  	const double u = t - offset[k];
+  	return 7.5625*u*u + height[k];
+  }
+  template <typename T>
+  static T InBounce (double t, T b , T c, double d) {
+  	return c * (1 - bounce(1 - t/d)) + b;
+  }
+  template <typename T>
+  static T OutBounce (double t, T b , T c, double d) {
+  	return c * bounce(t/d) + b;
+  }
+  template <typename T>
+  static T InOutBounce (double t, T b , T c, double d) {
+  	// Both halves bounce on |2t/d - 1|, the first one mirrored
+  	const double u = 2*t/d - 1;
+  	const double side = (u < 0) ? -.5 : .5;
+  	return c * (.5 + side * bounce(std::fabs(u))) + b;
+  }
   // ------ Circ --------------------------------------------------------------
   template <typename T>
   static T InCirc (double t, T b , T c, double d) {
@@ -160,37 +161,35 @@ struct Ease
   	return c/2*((t-=2)*t*t + 2) + b;	
   }
   // ------ Elastic -----------------------------------------------------------
-  // template <typename T>
-  // static T InElastic (double t, T b , T c, double d) {
-  //  if (t==0) return b;  if ((t/=d)==1) return b+c;  
-  //  T p=T(d*.3f);
-  //  T a=c; 
-  //  T s=p/4;
-  //  T postFix =a*std::pow(2,10*(t-=1)); // this is a fix, again, with post-increment operators
-  //  return -(postFix * std::sin((t*d-s)*(2*PI)/p )) + b;
-  // }
-  // template <typename T>
-  // static T OutElastic(double t, T b , T c, double d) {
-  //  if (t==0) return b;  if ((t/=d)==1) return b+c;  
-  //  T p=d*.3f;
-  //  T a=c; 
-  //  T s=p/4;
-  //  return (a*pow(2,-10*t) * sin( (t*d-s)*(2*PI)/p ) + c + b);  
-  // }
-  // template <typename T>
-  // static T InOutElastic(double t, T b , T c, double d) {
-  //  if (t==0) return b;  if ((t/=d/2)==2) return b+c; 
-  //  T p=d*(.3f*1.5f);
-  //  T a=c; 
-  //  T s=p/4;
-  // 
-  //  if (t < 1) {
-  //    T postFix =a*std::pow(2,10*(t-=1)); // postIncrement is evil
-  //    return -.5f*(postFix* std::sin( (t*d-s)*(2*PI)/p )) + b;
-  //  } 
-  //  T postFix =  a*std::pow(2,-10*(t-=1)); // postIncrement is evil
-  //  return postFix * std::sin( (t*d-s)*(2*PI)/p )*.5f + c + b;
-  // }
+  // Penner's defaults, amplitude = c and period = .3 d (.45 d for InOut). The
+  // t == 0 and t == d cases are selects so there's nothing to mispredict
+  template <typename T>
+  static T InElastic (double t, T b , T c, double d) {
+  	const double x = t/d - 1;
+  	double e = -std::pow(2, 10*x) * std::sin((x - .075) * (2*PI) / .3);
+  	e = (t > 0) ? e : 0;
+  	e = (t < d) ? e : 1;
+  	return c * e + b;
+  }
+  template <typename T>
+  static T OutElastic(double t, T b , T c, double d) {
+  	const double x = t/d;
+  	double e = std::pow(2, -10*x) * std::sin((x - .075) * (2*PI) / .3) + 1;
+  	e = (t > 0) ? e : 0;
+  	e = (t < d) ? e : 1;
+  	return c * e + b;
+  }
+  template <typename T>
+  static T InOutElastic(double t, T b , T c, double d) {
+  	// Both halves decay with 2^(-10 |2t/d - 1|), the first one mirrored
+  	const double x = 2*t/d - 1;
+  	const double w = .5 * std::pow(2, -10*std::fabs(x)) 
+  	                    * std::sin((x - .1125) * (2*PI) / .45);
+  	double e = (x < 0) ? -w : w + 1;
+  	e = (t > 0) ? e : 0;
+  	e = (t < d) ? e : 1;
+  	return c * e + b;
+  }
   // ------ Expo --------------------------------------------------------------
   template <typename T>
   static T InExpo (double t, T b , T c, double d) {
@@ -258,4 +257,83 @@ struct Ease
   	return c/2*((t-=2)*t*t*t*t + 2) + b;
   }
 };
-} // namespace rp
\ No newline at end of file
+
+/*=============================================================================
+          EaseKind: enumerated easing curves
+===============================================================================
+
+  Compact storage can't afford a function pointer per animation, so every
+  curve above is also addressable by a one byte index. Only ever append to
+  this list, the values end up in stored data.
+
+*/
+struct EaseKind
+{
+  enum Type {
+    NoneLinear, InLinear, OutLinear, InOutLinear,
+    InSine,     OutSine,  InOutSine,
+    InBack,     OutBack,  InOutBack,
+    InCirc,     OutCirc,  InOutCirc,
+    InCubic,    OutCubic, InOutCubic,
+    InExpo,     OutExpo,  InOutExpo,
+    InQuad,     OutQuad,  InOutQuad,
+    InQuart,    OutQuart, InOutQuart,
+    InQuint,    OutQuint, InOutQuint,
+    InBounce,   OutBounce,  InOutBounce,
+    InElastic,  OutElastic, InOutElastic,
+    Count
+  };
+};
+
+template <typename T>
+struct EaseTable
+{
+  typedef T (*Method)(double t, T b, T c, double d);
+  static const Method methods[EaseKind::Count];
+  
+  // ------ method(): function pointer for an enumerated curve ----------------
+  static Method method(EaseKind::Type kind) {
+    return methods[kind];
+  }
+  
+  // ------ find(): enumerated curve for a function pointer -------------------
+  // Returns EaseKind::Count when the method isn't one of ours
+  static EaseKind::Type find(Method m) {
+    for (int i = 0; i < EaseKind::Count; i++) {
+      if (methods[i] == m) return EaseKind::Type(i);
+    }
+    return EaseKind::Count;
+  }
+};
+
+template <typename T>
+const typename EaseTable<T>::Method EaseTable<T>::methods[EaseKind::Count] = {
+  &Ease::NoneLinear<T>, &Ease::InLinear<T>, &Ease::OutLinear<T>, &Ease::InOutLinear<T>,
+  &Ease::InSine<T>,     &Ease::OutSine<T>,  &Ease::InOutSine<T>,
+  &Ease::InBack<T>,     &Ease::OutBack<T>,  &Ease::InOutBack<T>,
+  &Ease::InCirc<T>,     &Ease::OutCirc<T>,  &Ease::InOutCirc<T>,
+  &Ease::InCubic<T>,    &Ease::OutCubic<T>, &Ease::InOutCubic<T>,
+  &Ease::InExpo<T>,     &Ease::OutExpo<T>,  &Ease::InOutExpo<T>,
+  &Ease::InQuad<T>,     &Ease::OutQuad<T>,  &Ease::InOutQuad<T>,
+  &Ease::InQuart<T>,    &Ease::OutQuart<T>, &Ease::InOutQuart<T>,
+  &Ease::InQuint<T>,    &Ease::OutQuint<T>, &Ease::InOutQuint<T>,
+  &Ease::InBounce<T>,   &Ease::OutBounce<T>,  &Ease::InOutBounce<T>,
+  &Ease::InElastic<T>,  &Ease::OutElastic<T>, &Ease::InOutElastic<T>
+};
+
+} // namespace rp
+
+// Same order as EaseKind, append here when a curve is added there. X(fn, ease)
+// is expanded once per curve, for tables of kernels templated on the curve
+#define ANI_EASE_CURVES(X, fn)                                               \
+  X(fn, NoneLinear) X(fn, InLinear)  X(fn, OutLinear)  X(fn, InOutLinear)    \
+  X(fn, InSine)     X(fn, OutSine)   X(fn, InOutSine)                        \
+  X(fn, InBack)     X(fn, OutBack)   X(fn, InOutBack)                        \
+  X(fn, InCirc)     X(fn, OutCirc)   X(fn, InOutCirc)                        \
+  X(fn, InCubic)    X(fn, OutCubic)  X(fn, InOutCubic)                       \
+  X(fn, InExpo)     X(fn, OutExpo)   X(fn, InOutExpo)                        \
+  X(fn, InQuad)     X(fn, OutQuad)   X(fn, InOutQuad)                        \
+  X(fn, InQuart)    X(fn, OutQuart)  X(fn, InOutQuart)                       \
+  X(fn, InQuint)    X(fn, OutQuint)  X(fn, InOutQuint)                       \
+  X(fn, InBounce)   X(fn, OutBounce) X(fn, InOutBounce)                      \
+  X(fn, InElastic)  X(fn, OutElastic) X(fn, InOutElastic)
@@ -0,0 +1,246 @@
+//  ------------------------------------------------------------------------ // 
+//  ===== EaseBezier.h ===================================================== // 
+//  ------------------------------------------------------------------------ // 
+//   Created:        Kevin Webster                                           // 
+//   Date:           26.10.19                                                // 
+//   Copyright (c)   2010 All rights reserved.                               // 
+//  ------------------------------------------------------------------------ // 
+//  Redistribution and use in source and binary forms, with or without       // 
+//  modification, are permitted provided that the following conditions       // 
+//  are met:                                                                 // 
+//                                                                           // 
+//     * Redistributions of source code must retain the above copyright      // 
+//       notice, this list of conditions and the following disclaimer.       // 
+//     * Redistributions in binary form must reproduce the above copyright   // 
+//       notice, this list of conditions and the following disclaimer in     // 
+//       the documentation and/or other materials provided with the          // 
+//       distribution.                                                       // 
+//     * Stealing is also kinda lame.                                        // 
+//                                                                           // 
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS      // 
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT        // 
+//  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR    // 
+//  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT     // 
+//  HOLDER OR CONTRIBUTORS BE LIABLEFOR ANY DIRECT, INDIRECT, INCIDENTAL,    // 
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED // 
+//  TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR   // 
+//  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF   // 
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING     // 
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS       // 
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.             // 
+//  ------------------------------------------------------------------------ // 
+
+#pragma once
+
+#include <cmath>
+
+#include "Ease.h"
+
+#if __cplusplus >= 201103L
+#include <mutex>
+#endif
+
+#ifndef ANI_BEZIER_CURVES
+#define ANI_BEZIER_CURVES 64
+#endif
+
+namespace rp {
+
+/*=============================================================================
+          CubicBezier: CSS style cubic-bezier(x1, y1, x2, y2) curve
+===============================================================================
+
+  Solving x -> t is done with a few Newton iterations seeded from a small 
+  table of t sampled at even steps of x, filled once with bisection. Plain 
+  aggregate so registry storage needs no construction.
+
+*/
+struct CubicBezier
+{
+  enum { Samples = 17 };
+  
+  double x1, y1, x2, y2;
+  double ax, bx, cx;
+  double ay, by, cy;
+  double samples[Samples]; // t at x = i / (Samples - 1)
+  
+  void init(double px1, double py1, double px2, double py2) {
+    x1 = px1; y1 = py1; x2 = px2; y2 = py2;
+    
+    cx = 3 * x1;
+    bx = 3 * (x2 - x1) - cx;
+    ax = 1 - cx - bx;
+    cy = 3 * y1;
+    by = 3 * (y2 - y1) - cy;
+    ay = 1 - cy - by;
+    
+    for (int i = 0; i < Samples; i++) {
+      samples[i] = bisect(double(i) / (Samples - 1));
+    }
+  }
+  
+  bool matches(double px1, double py1, double px2, double py2) const {
+    return x1 == px1 && y1 == py1 && x2 == px2 && y2 == py2;
+  }
+  
+  double curveX(double t) const { return ((ax * t + bx) * t + cx) * t; }
+  double curveY(double t) const { return ((ay * t + by) * t + cy) * t; }
+  double slopeX(double t) const { return (3 * ax * t + 2 * bx) * t + cx; }
+  
+  // ------ solve(): eased progress for x in [0, 1] ---------------------------
+  double solve(double x) const {
+    if (x <= 0) return 0;
+    if (x >= 1) return 1;
+    return curveY(solveT(x));
+  }
+  
+  double solveT(double x) const {
+    // ------ Seed from the sample table --------------------------------------
+    double s = x * (Samples - 1);
+    int i = (s < Samples - 1) ? int(s) : Samples - 2;
+    double lo = samples[i], hi = samples[i + 1];
+    double t = lo + (hi - lo) * (s - i);
+    
+    // ------ Newton, bisect the bracket where it stalls or overshoots --------
+    for (int n = 0; n < 4; n++) {
+      double err = curveX(t) - x;
+      if (std::fabs(err) < 1e-7) 
+        return t;
+      double slope = slopeX(t);
+      t = (slope > 1e-6) ? t - err / slope : lo - 1;
+      if (t < lo || t > hi) 
+        break;
+    }
+    return bisect(x, lo, hi);
+  }
+  
+  double bisect(double x, double lo = 0, double hi = 1) const {
+    double t = x;
+    for (int n = 0; n < 32; n++) {
+      t = (lo + hi) * 0.5;
+      if (curveX(t) > x) hi = t;
+      else lo = t;
+    }
+    return t;
+  }
+};
+
+/*=============================================================================
+          EaseBezier: cubic-bezier curves as easing methods
+===============================================================================
+
+  Easing methods are plain function pointers, so a curve can't carry its
+  own state. Instead every distinct curve gets one of ANI_BEZIER_CURVES
+  registry slots, each backed by its own function. Asking for the same
+  curve twice hands back the same function, the setup is paid once.
+  
+    ani.mate(&var)->go(1.0, 10, EaseBezier::method<float>(.25, .1, .25, 1));
+  
+  Once every slot is taken new curves get Ease::NoneLinear, define 
+  ANI_BEZIER_CURVES to get more. Under C++11 and later the registry is 
+  locked, so curves can be created from Scheduler workers.
+  
+*/
+struct EaseBezier
+{
+  // ------ method(): retreive or create the easing method for a curve --------
+  template <typename T>
+  static T (*method(double x1, double y1, double x2, double y2))(double, T, T, double) {
+    int slot = find(x1, y1, x2, y2);
+    if (slot < 0) return &Ease::NoneLinear<T>;
+    return Slots<T>::methods()[slot];
+  }
+  
+  // ------ slotOf(): registry slot behind a method, -1 if not ours -----------
+  template <typename T>
+  static int slotOf(T (*m)(double, T, T, double)) {
+#if __cplusplus >= 201103L
+    std::lock_guard<std::mutex> hold(Registry<0>::lock());
+#endif
+    for (int i = 0; i < Registry<0>::count; i++) {
+      if (Slots<T>::methods()[i] == m) return i;
+    }
+    return -1;
+  }
+  
+  // ------ curve(): the solver behind a slot ---------------------------------
+  static const CubicBezier& curve(int slot) {
+    return Registry<0>::curves[slot];
+  }
+  
+  static int find(double x1, double y1, double x2, double y2) {
+#if __cplusplus >= 201103L
+    std::lock_guard<std::mutex> hold(Registry<0>::lock());
+#endif
+    int count = Registry<0>::count;
+    for (int i = 0; i < count; i++) {
+      if (Registry<0>::curves[i].matches(x1, y1, x2, y2)) return i;
+    }
+    if (count == ANI_BEZIER_CURVES) 
+      return -1;
+    
+    Registry<0>::curves[count].init(x1, y1, x2, y2);
+    Registry<0>::count = count + 1;
+    return count;
+  }
+  
+ private:
+  // Template only so the storage can live in a header
+  template <int Dummy>
+  struct Registry
+  {
+    static CubicBezier curves[ANI_BEZIER_CURVES];
+    static int         count;
+    
+#if __cplusplus >= 201103L
+    static std::mutex& lock() {
+      static std::mutex m;
+      return m;
+    }
+#endif
+  };
+  
+  template <int N, typename T>
+  static T slot(double t, T b, T c, double d) {
+    return c * Registry<0>::curves[N].solve(t / d) + b;
+  }
+  
+  template <typename T, int N>
+  struct Fill
+  {
+    static void into(T (**m)(double, T, T, double)) {
+      m[N - 1] = &EaseBezier::slot<N - 1, T>;
+      Fill<T, N - 1>::into(m);
+    }
+  };
+  template <typename T>
+  struct Fill<T, 0>
+  {
+    static void into(T (**m)(double, T, T, double)) {}
+  };
+  
+  template <typename T>
+  struct Slots
+  {
+    typedef T (*Method)(double t, T b, T c, double d);
+    
+    struct Table
+    {
+      Table () { Fill<T, ANI_BEZIER_CURVES>::into(methods); }
+      Method methods[ANI_BEZIER_CURVES];
+    };
+    
+    // Function-local static, initialized once even across threads in C++11
+    static Method* methods() {
+      static Table table;
+      return table.methods;
+    }
+  };
+};
+
+template <int Dummy>
+CubicBezier EaseBezier::Registry<Dummy>::curves[ANI_BEZIER_CURVES];
+template <int Dummy>
+int EaseBezier::Registry<Dummy>::count = 0;
+
+} // namespace rp
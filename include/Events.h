@@ -0,0 +1,173 @@
+//  ------------------------------------------------------------------------ // 
+//  ===== Events.h ========================================================= // 
+//  ------------------------------------------------------------------------ // 
+//   Created:        Kevin Webster                                           // 
+//   Date:           26.10.19                                                // 
+//   Copyright (c)   2010 All rights reserved.                               // 
+//  ------------------------------------------------------------------------ // 
+//  Redistribution and use in source and binary forms, with or without       // 
+//  modification, are permitted provided that the following conditions       // 
+//  are met:                                                                 // 
+//                                                                           // 
+//     * Redistributions of source code must retain the above copyright      // 
+//       notice, this list of conditions and the following disclaimer.       // 
+//     * Redistributions in binary form must reproduce the above copyright   // 
+//       notice, this list of conditions and the following disclaimer in     // 
+//       the documentation and/or other materials provided with the          // 
+//       distribution.                                                       // 
+//     * Stealing is also kinda lame.                                        // 
+//                                                                           // 
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS      // 
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT        // 
+//  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR    // 
+//  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT     // 
+//  HOLDER OR CONTRIBUTORS BE LIABLEFOR ANY DIRECT, INDIRECT, INCIDENTAL,    // 
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED // 
+//  TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR   // 
+//  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF   // 
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING     // 
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS       // 
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.             // 
+//  ------------------------------------------------------------------------ // 
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include "Callback.h"
+#include "Trace.h"
+
+namespace rp {
+
+struct EventKind
+{
+  enum Type { Start, Step, Finish };
+};
+
+struct AnimationEvent
+{
+  callbackBase* callback; // 0 when the animation only has an event id
+  uint32_t      id;       // AnimationBase::setEventId(), 0 if unset
+  uint8_t       kind;     // EventKind::Type
+};
+
+/*=============================================================================
+          EventRing: deferred start/step/finish notifications
+===============================================================================
+
+  With a ring attached, animations don't run callbacks in the middle of
+  Ani::update(). They append a record here instead, and the callbacks run
+  in one batch from dispatch(), where calling mate() or remove() is safe.
+  
+  Animations with an event id are recorded even without callbacks, so a
+  caller can read the records by id and clear() on its own schedule.
+  
+  Finish callbacks are handed over to the ring when recorded. Start and 
+  step callbacks stay with their animation, animations destroyed before 
+  the next dispatch() or clear() park them in a retire list until then.
+  
+  The ring never grows, records pushed while it's full are counted in 
+  dropped() and their finish callbacks released without running.
+
+*/
+class EventRing
+{
+ public:
+  EventRing () : head_(0), size_(0), dropped_(0) {}
+  EventRing (size_t capacity) : head_(0), size_(0), dropped_(0) {
+    reserve(capacity);
+  }
+  ~EventRing () { clear(); }
+  
+  void reserve(size_t capacity) {
+    clear();
+    records_.resize(capacity);
+    retired_.reserve(capacity);
+    head_ = 0;
+  }
+  
+  // ------ push(): called by animations during update ------------------------
+  void push(callbackBase* callback, uint32_t id, EventKind::Type kind) {
+    if (size_ == records_.size()) {
+      dropped_++;
+      if (callback && kind == EventKind::Finish) 
+        callback->release();
+      return;
+    }
+    AnimationEvent& e = records_[(head_ + size_) % records_.size()];
+    e.callback = callback;
+    e.id       = id;
+    e.kind     = uint8_t(kind);
+    size_++;
+  }
+  
+  // ------ retire(): release a callback once no record can point at it -------
+  void retire(callbackBase* callback) {
+    retired_.push_back(callback);
+  }
+  
+  // ------ dispatch(): run every recorded callback, oldest first -------------
+  void dispatch() {
+    while (size_) {
+      AnimationEvent e = pop();
+      if (!e.callback) 
+        continue;
+      ANI_TRACE_SCOPE("callback", e.callback);
+      if (e.kind == EventKind::Finish) 
+        e.callback->fire();
+      else 
+        e.callback->exec();
+    }
+    releaseRetired();
+  }
+  
+  // ------ clear(): drop records without running them ------------------------
+  void clear() {
+    while (size_) {
+      AnimationEvent e = pop();
+      if (e.callback && e.kind == EventKind::Finish) 
+        e.callback->release();
+    }
+    releaseRetired();
+  }
+  
+  // ------ Queries -----------------------------------------------------------
+  size_t size() const { 
+    return size_; 
+  }
+  size_t capacity() const { 
+    return records_.size(); 
+  }
+  size_t dropped() const { 
+    return dropped_; 
+  }
+  // Oldest first
+  const AnimationEvent& operator[](size_t i) const {
+    return records_[(head_ + i) % records_.size()];
+  }
+  
+ private:
+  AnimationEvent pop() {
+    AnimationEvent e = records_[head_];
+    head_ = (head_ + 1) % records_.size();
+    size_--;
+    return e;
+  }
+  
+  void releaseRetired() {
+    for (size_t i = 0; i < retired_.size(); i++) {
+      retired_[i]->release();
+    }
+    retired_.clear();
+  }
+  
+ private:
+  std::vector<AnimationEvent> records_;
+  std::vector<callbackBase*>  retired_;
+  size_t                      head_;
+  size_t                      size_;
+  size_t                      dropped_;
+};
+
+} // namespace rp
@@ -0,0 +1,303 @@
+//  ------------------------------------------------------------------------ // 
+//  ===== Fixed.h ========================================================== // 
+//  ------------------------------------------------------------------------ // 
+//   Created:        Kevin Webster                                           // 
+//   Date:           26.10.19                                                // 
+//   Copyright (c)   2010 All rights reserved.                               // 
+//  ------------------------------------------------------------------------ // 
+//  Redistribution and use in source and binary forms, with or without       // 
+//  modification, are permitted provided that the following conditions       // 
+//  are met:                                                                 // 
+//                                                                           // 
+//     * Redistributions of source code must retain the above copyright      // 
+//       notice, this list of conditions and the following disclaimer.       // 
+//     * Redistributions in binary form must reproduce the above copyright   // 
+//       notice, this list of conditions and the following disclaimer in     // 
+//       the documentation and/or other materials provided with the          // 
+//       distribution.                                                       // 
+//     * Stealing is also kinda lame.                                        // 
+//                                                                           // 
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS      // 
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT        // 
+//  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR    // 
+//  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT     // 
+//  HOLDER OR CONTRIBUTORS BE LIABLEFOR ANY DIRECT, INDIRECT, INCIDENTAL,    // 
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED // 
+//  TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR   // 
+//  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF   // 
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING     // 
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS       // 
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.             // 
+//  ------------------------------------------------------------------------ // 
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+#include "Ease.h"
+#include "Animator.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ANI_HAS_SSE2 1
+#endif
+
+namespace rp {
+
+/*
+// ====== Fixed Point Animation ===============================================
+For big integer buffers, RGBA pixels, LED strips, int16_t offsets, where 
+going through double per element costs more than the memory traffic does.
+
+A FixedCurve turns any Ease curve into a table of eased progress in Q14 
+fixed point, 1.0 is 16384. Built once, looked up with integer math:
+
+  static const FixedCurve fade(Ease::InOutCubic);
+  int16_t w = fade.at(progress);
+
+FixedBatch blends whole arrays with one such weight, 16 bytes at a time on
+SSE2, saturating at the type's range so overshooting curves clip instead
+of wrapping around:
+
+  FixedBatch::lerp(from, to, w, pixels, n);
+
+And fixedAnimator does both for whole buffers under an Ani. Like compact 
+records, buffers pick up their begin values on the first update and have 
+no callbacks. The target and the curve are not copied, keep them around:
+
+  ani.fixed<uint8_t>()->go(pixels, black, n, .5, &fade);
+
+*/
+class FixedCurve
+{
+ public:
+  enum { Steps = 256, One = 1 << 14 };
+  
+  FixedCurve (double (*easing)(double t, double b, double c, double d) = Ease::NoneLinear) {
+    for (int i = 0; i <= Steps; i++) {
+      double v = easing(double(i) / int(Steps), 0, One, 1);
+      // both weights One - w and w have to fit an int16_t
+      v = v < 1 - One ? 1 - One : (v > 32767 ? 32767 : v);
+      table_[i] = int16_t(v < 0 ? v - .5 : v + .5);
+    }
+  }
+  
+  // ------ lookup(): eased progress for progress in Q16, 0..65536 ------------
+  int16_t lookup(uint32_t t) const {
+    if (t >= 65536) 
+      return table_[Steps];
+    const uint32_t i = t >> 8, f = t & 255;
+    return int16_t(table_[i] + (((table_[i + 1] - table_[i]) * int32_t(f) + 128) >> 8));
+  }
+  int16_t at(double t) const {
+    return lookup(uint32_t(t <= 0 ? 0 : (t >= 1 ? 65536 : t * 65536 + .5)));
+  }
+  
+ private:
+  int16_t table_[Steps + 1];
+};
+
+
+/*=============================================================================
+          FixedBatch: from + (to - from) * w over arrays, w in Q14
+=============================================================================*/
+struct FixedBatch
+{
+  static void lerp(const uint8_t* from, const uint8_t* to, int16_t w, uint8_t* out, size_t n) {
+    size_t i = 0;
+#ifdef ANI_HAS_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i wts = weights(w);
+    for (; i + 16 <= n; i += 16) {
+      const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(from + i));
+      const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(to + i));
+      const __m128i lo = blend(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero), wts);
+      const __m128i hi = blend(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero), wts);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packus_epi16(lo, hi));
+    }
+#endif
+    for (; i < n; i++) {
+      const int32_t v = blend(from[i], to[i], w);
+      out[i] = uint8_t(v < 0 ? 0 : (v > 255 ? 255 : v));
+    }
+  }
+  
+  static void lerp(const int16_t* from, const int16_t* to, int16_t w, int16_t* out, size_t n) {
+    size_t i = 0;
+#ifdef ANI_HAS_SSE2
+    const __m128i wts = weights(w);
+    for (; i + 8 <= n; i += 8) {
+      const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(from + i));
+      const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(to + i));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), blend(a, b, wts));
+    }
+#endif
+    for (; i < n; i++) {
+      const int32_t v = blend(from[i], to[i], w);
+      out[i] = int16_t(v < -32768 ? -32768 : (v > 32767 ? 32767 : v));
+    }
+  }
+  
+ private:
+  // ------ blend(): (a (One - w) + b w) / One, rounded -----------------------
+  // Fits an int32_t for any w FixedCurve makes and any int16_t a and b
+  static int32_t blend(int32_t a, int32_t b, int32_t w) {
+    return (a * (FixedCurve::One - w) + b * w + FixedCurve::One / 2) >> 14;
+  }
+  
+#ifdef ANI_HAS_SSE2
+  static __m128i weights(int16_t w) {
+    return _mm_set1_epi32(int32_t((uint32_t(uint16_t(w)) << 16) | 
+                                  uint16_t(FixedCurve::One - w)));
+  }
+  // Eight int16_t lanes each of a and b, saturated back to eight int16_t
+  static __m128i blend(__m128i a, __m128i b, __m128i wts) {
+    const __m128i round = _mm_set1_epi32(FixedCurve::One / 2);
+    const __m128i lo = _mm_madd_epi16(_mm_unpacklo_epi16(a, b), wts);
+    const __m128i hi = _mm_madd_epi16(_mm_unpackhi_epi16(a, b), wts);
+    return _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(lo, round), 14),
+                           _mm_srai_epi32(_mm_add_epi32(hi, round), 14));
+  }
+#endif
+};
+
+
+template <typename T>
+struct FixedAnimation
+{
+  T*                buffer;
+  const T*          target;
+  size_t            size;
+  double            start;
+  double            duration;
+  const FixedCurve* curve;      // 0 for linear
+  std::vector<T>    beginning;  // copied on the first update
+};
+
+
+/*=============================================================================
+          fixedAnimator: whole uint8_t or int16_t buffers, one weight each
+=============================================================================*/
+template <typename T>
+class fixedAnimator : public Animator
+{
+ public:
+  fixedAnimator () {}
+  
+  // ------ go(): blend buffer towards target over duration ------------------
+  fixedAnimator<T>* go(T* buffer, const T* target, size_t n, double duration,
+                       const FixedCurve* curve = 0, double delay = 0)
+  {
+    FixedAnimation<T> anim;
+    anim.buffer   = buffer;
+    anim.target   = target;
+    anim.size     = n;
+    anim.start    = delay;
+    anim.duration = duration;
+    anim.curve    = curve;
+    starting_.push_back(anim);
+    return this;
+  }
+  
+  // ------ Buttons -----------------------------------------------------------
+  fixedAnimator<T>* stop(T* buffer) {
+    drop(starting_, buffer);
+    drop(animations_, buffer);
+    return this;
+  }
+  fixedAnimator<T>* stop() {
+    starting_.clear();
+    while (!animations_.empty()) {
+      remove(animations_, animations_.size() - 1);
+    }
+    return this;
+  }
+  
+  // ------ Queries -----------------------------------------------------------
+  bool isAnimating() {
+    return size() > 0;
+  }
+  size_t size() {
+    return starting_.size() + animations_.size();
+  }
+  size_t activeCount() {
+    return size();
+  }
+  
+  // ------ Updater -----------------------------------------------------------
+  void update(const double ttime) {
+    for (size_t i = 0; i < starting_.size(); i++) {
+      FixedAnimation<T>& anim = starting_[i];
+      anim.start += ttime;
+      animations_.push_back(anim);
+      std::vector<T>& beginning = animations_.back().beginning;
+      if (!spare_.empty()) {
+        beginning.swap(spare_.back());
+        spare_.pop_back();
+      }
+      beginning.assign(anim.buffer, anim.buffer + anim.size);
+    }
+    starting_.clear();
+    
+    for (size_t i = 0; i < animations_.size(); ) {
+      FixedAnimation<T>& anim = animations_[i];
+      if (ttime < anim.start) { // delaying
+        ++i;
+        continue;
+      }
+      
+      const double nT = anim.duration > 0 ? (ttime - anim.start) / anim.duration : 1;
+      const int16_t w = anim.curve ? anim.curve->at(nT) 
+                                   : int16_t(nT >= 1 ? int(FixedCurve::One) 
+                                                     : int(nT * int(FixedCurve::One) + .5));
+      if (anim.size) 
+        FixedBatch::lerp(&anim.beginning[0], anim.target, w, anim.buffer, anim.size);
+      
+      if (nT >= 1) {
+        remove(animations_, i);
+      } else {
+        ++i;
+      }
+    }
+  }
+  
+ protected:
+  typedef std::vector<FixedAnimation<T> > Animations;
+  
+  // ------ remove(): swap with the last one, keeping the beginning's memory --
+  // The retired beginning goes to spare_ for the next go() to fill
+  void remove(Animations& animations, size_t i) {
+    if (animations[i].beginning.capacity()) {
+      spare_.push_back(std::vector<T>());
+      spare_.back().swap(animations[i].beginning);
+    }
+    
+    FixedAnimation<T>& last = animations.back();
+    if (&animations[i] != &last) {
+      std::vector<T> beginning;
+      beginning.swap(last.beginning);
+      animations[i] = last;
+      animations[i].beginning.swap(beginning);
+    }
+    animations.pop_back();
+  }
+  
+  void drop(Animations& animations, T* buffer) {
+    for (size_t i = 0; i < animations.size(); ) {
+      if (animations[i].buffer == buffer) {
+        remove(animations, i);
+      } else {
+        ++i;
+      }
+    }
+  }
+  
+ protected:
+  Animations starting_;   // go() since the last update
+  Animations animations_;
+  std::vector<std::vector<T> > spare_;   // retired beginnings, empty but allocated
+};
+
+} // namespace rp
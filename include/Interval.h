@@ -0,0 +1,241 @@
+//  ------------------------------------------------------------------------ // 
+//  ===== Interval.h ======================================================= // 
+//  ------------------------------------------------------------------------ // 
+//   Created:        Kevin Webster                                           // 
+//   Date:           26.10.19                                                // 
+//   Copyright (c)   2010 All rights reserved.                               // 
+//  ------------------------------------------------------------------------ // 
+//  Redistribution and use in source and binary forms, with or without       // 
+//  modification, are permitted provided that the following conditions       // 
+//  are met:                                                                 // 
+//                                                                           // 
+//     * Redistributions of source code must retain the above copyright      // 
+//       notice, this list of conditions and the following disclaimer.       // 
+//     * Redistributions in binary form must reproduce the above copyright   // 
+//       notice, this list of conditions and the following disclaimer in     // 
+//       the documentation and/or other materials provided with the          // 
+//       distribution.                                                       // 
+//     * Stealing is also kinda lame.                                        // 
+//                                                                           // 
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS      // 
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT        // 
+//  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR    // 
+//  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT     // 
+//  HOLDER OR CONTRIBUTORS BE LIABLEFOR ANY DIRECT, INDIRECT, INCIDENTAL,    // 
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED // 
+//  TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR   // 
+//  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF   // 
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING     // 
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS       // 
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.             // 
+//  ------------------------------------------------------------------------ // 
+
+#pragma once
+
+#include <stdint.h>
+#include <cmath>
+#include <vector>
+
+#include "Pool.h"
+
+namespace rp {
+
+class Animator;
+
+/*=============================================================================
+          IntervalNode: one indexed animation
+=============================================================================*/
+struct IntervalNode : public Pooled
+{
+  double          start;     // absolute, after the delay
+  double          end;       // HUGE_VAL for animations that never finish
+  Animator*       animator;
+  const void*     animation; // the AnimationBase<T>, type erased
+  
+  // ------ Treap internals ---------------------------------------------------
+  double          maxEnd;    // largest end in this subtree
+  uint32_t        priority;
+  IntervalNode*   left;
+  IntervalNode*   right;
+};
+
+/*=============================================================================
+          IntervalIndex: queued animations by absolute time
+===============================================================================
+
+  A treap ordered by start time, every node also knows the largest end time
+  below it. That's enough to answer "what overlaps [t0, t1]" by skipping 
+  whole subtrees. Insert and erase are O(log n) expected, a query with k 
+  matches is O(k log n) at worst, every match can cost a walk down its 
+  own path, and never worse than visiting all n.
+  
+  Ani::indexIntervals() hands one to its animators, which keep it up to date
+  on go(), stop() and completion. Times of queued animations are estimates, 
+  they are corrected once the animation in front of them actually starts.
+
+*/
+class IntervalIndex
+{
+ public:
+  IntervalIndex () : root_(0), size_(0), seed_(2463534242u) {}
+  ~IntervalIndex () { clear(); }
+  
+  // ------ insert(): returns the node to erase() it with ---------------------
+  IntervalNode* insert(double start, double end, Animator* animator, 
+                       const void* animation) 
+  {
+    IntervalNode* n = new IntervalNode();
+    n->start     = start;
+    n->end       = end;
+    n->animator  = animator;
+    n->animation = animation;
+    n->maxEnd    = end;
+    n->priority  = random();
+    n->left      = 0;
+    n->right     = 0;
+    
+    IntervalNode *l, *r;
+    split(root_, n, l, r);
+    root_ = merge(merge(l, n), r);
+    size_++;
+    return n;
+  }
+  
+  void erase(IntervalNode* node) {
+    root_ = erase(root_, node);
+    delete node;
+    size_--;
+  }
+  
+  // ------ move(): new times for a node, keeps the node ----------------------
+  void move(IntervalNode* node, double start, double end) {
+    if (node->start == start && node->end == end) 
+      return;
+    root_ = erase(root_, node);
+    node->start  = start;
+    node->end    = end;
+    node->maxEnd = end;
+    node->left   = 0;
+    node->right  = 0;
+    
+    IntervalNode *l, *r;
+    split(root_, node, l, r);
+    root_ = merge(merge(l, node), r);
+  }
+  
+  // ------ Queries, matches are appended to out ------------------------------
+  // Everything active at some point in [t0, t1], which includes starting in it
+  size_t query(double t0, double t1, std::vector<const IntervalNode*>& out) const {
+    size_t before = out.size();
+    query(root_, t0, t1, out);
+    return out.size() - before;
+  }
+  // Everything active at t
+  size_t stab(double t, std::vector<const IntervalNode*>& out) const {
+    return query(t, t, out);
+  }
+  
+  size_t size() const { return size_; }
+  
+  void clear() {
+    clear(root_);
+    root_ = 0;
+    size_ = 0;
+  }
+  
+ private:
+  IntervalIndex (const IntervalIndex&);
+  IntervalIndex& operator=(const IntervalIndex&);
+  
+  // Ties on start are broken by address, so every node has a unique key
+  static bool less(const IntervalNode* a, const IntervalNode* b) {
+    return a->start < b->start || (a->start == b->start && a < b);
+  }
+  
+  static void fix(IntervalNode* n) {
+    double m = n->end;
+    if (n->left && n->left->maxEnd > m)   m = n->left->maxEnd;
+    if (n->right && n->right->maxEnd > m) m = n->right->maxEnd;
+    n->maxEnd = m;
+  }
+  
+  // ------ split(): keys below key to l, the rest to r -----------------------
+  static void split(IntervalNode* t, const IntervalNode* key, 
+                    IntervalNode*& l, IntervalNode*& r) 
+  {
+    if (!t) {
+      l = r = 0;
+    } else if (less(t, key)) {
+      split(t->right, key, t->right, r);
+      l = t;
+      fix(t);
+    } else {
+      split(t->left, key, l, t->left);
+      r = t;
+      fix(t);
+    }
+  }
+  
+  static IntervalNode* merge(IntervalNode* l, IntervalNode* r) {
+    if (!l) return r;
+    if (!r) return l;
+    if (l->priority > r->priority) {
+      l->right = merge(l->right, r);
+      fix(l);
+      return l;
+    }
+    r->left = merge(l, r->left);
+    fix(r);
+    return r;
+  }
+  
+  static IntervalNode* erase(IntervalNode* t, const IntervalNode* node) {
+    if (!t) 
+      return 0;
+    if (t == node) 
+      return merge(t->left, t->right);
+    if (less(node, t)) 
+      t->left = erase(t->left, node);
+    else 
+      t->right = erase(t->right, node);
+    fix(t);
+    return t;
+  }
+  
+  // ------ query(): skips subtrees that end before t0 or start after t1 -----
+  // A subtree ending at or after t0 may still hold no match, all of its 
+  // nodes starting after t1, so this isn't log n + k
+  static void query(const IntervalNode* t, double t0, double t1, 
+                    std::vector<const IntervalNode*>& out) 
+  {
+    while (t && t->maxEnd >= t0) {
+      query(t->left, t0, t1, out);
+      if (t->start > t1) 
+        return; // the right subtree starts even later
+      if (t->end >= t0) 
+        out.push_back(t);
+      t = t->right;
+    }
+  }
+  
+  static void clear(IntervalNode* t) {
+    if (!t) 
+      return;
+    clear(t->left);
+    clear(t->right);
+    delete t;
+  }
+  
+  uint32_t random() {
+    seed_ ^= seed_ << 13;
+    seed_ ^= seed_ >> 17;
+    seed_ ^= seed_ << 5;
+    return seed_;
+  }
+  
+  IntervalNode* root_;
+  size_t        size_;
+  uint32_t      seed_;
+};
+
+} // namespace rp
@@ -0,0 +1,248 @@
+//  ------------------------------------------------------------------------ // 
+//  ===== Path.h =========================================================== // 
+//  ------------------------------------------------------------------------ // 
+//   Created:        Kevin Webster                                           // 
+//   Date:           26.10.19                                                // 
+//   Copyright (c)   2010 All rights reserved.                               // 
+//  ------------------------------------------------------------------------ // 
+//  Redistribution and use in source and binary forms, with or without       // 
+//  modification, are permitted provided that the following conditions       // 
+//  are met:                                                                 // 
+//                                                                           // 
+//     * Redistributions of source code must retain the above copyright      // 
+//       notice, this list of conditions and the following disclaimer.       // 
+//     * Redistributions in binary form must reproduce the above copyright   // 
+//       notice, this list of conditions and the following disclaimer in     // 
+//       the documentation and/or other materials provided with the          // 
+//       distribution.                                                       // 
+//     * Stealing is also kinda lame.                                        // 
+//                                                                           // 
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS      // 
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT        // 
+//  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR    // 
+//  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT     // 
+//  HOLDER OR CONTRIBUTORS BE LIABLEFOR ANY DIRECT, INDIRECT, INCIDENTAL,    // 
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED // 
+//  TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR   // 
+//  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF   // 
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING     // 
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS       // 
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.             // 
+//  ------------------------------------------------------------------------ // 
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+#include "Value.h"
+#include "Ease.h"
+#include "Timing.h"
+#include "Animation.h"
+#include "Animator.h"
+
+namespace rp {
+
+/*=============================================================================
+          Path: Catmull-Rom & cubic Bezier paths with an arc-length table
+===============================================================================
+
+  Chaining linear tweens between points makes objects change speed at every
+  joint. A Path is built once from its control points and resamples itself
+  by arc length, so at(u) moves at constant speed as u goes from 0 to 1.
+  
+  Build it once and hand the same Path to every object following it, the
+  table is shared.
+  
+    CatmullRom: passes through every point, endpoints are duplicated
+    Bezier:     p0 c0 c1 p1 c2 c3 p2 ..., 3n+1 points
+  
+  Too few points for a single span (2, or 4 for Bezier) give a path that
+  stays on the first point, no points at all one that stays on T().
+  
+*/
+template <typename T>
+class Path
+{
+ public:
+  enum Type { CatmullRom, Bezier };
+  
+  Path (Type type, const T* points, size_t count, int resolution = 256) 
+        : type_(type), points_(points, points + count), length_(0)
+  {
+    if (points_.empty()) 
+      points_.push_back(T());
+    if (type_ == Bezier) 
+      spans_ = (count >= 4) ? (count - 1) / 3 : 0;
+    else 
+      spans_ = (count >= 2) ? count - 1 : 0;
+    build(resolution < 2 ? 2 : resolution);
+  }
+  
+  // ------ at(): position at arc-length fraction u ---------------------------
+  T at(double u) const {
+    if (u <= 0) return point(0);
+    if (u >= 1) return point(double(spans_));
+    
+    double x = u * (params_.size() - 1);
+    size_t i = size_t(x);
+    double f = x - i;
+    return point(params_[i] + (params_[i + 1] - params_[i]) * f);
+  }
+  
+  double length() const { 
+    return length_; 
+  }
+  
+ private:
+  // ------ point(): position at curve parameter s in [0, spans] --------------
+  T point(double s) const {
+    if (spans_ == 0) 
+      return points_[0];
+    
+    size_t span = size_t(s);
+    if (span >= spans_) span = spans_ - 1;
+    double t = s - span;
+    
+    if (type_ == Bezier) {
+      const T* p = &points_[span * 3];
+      double it = 1 - t;
+      return p[0] * (it * it * it) + p[1] * (3.0 * it * it * t) + 
+             p[2] * (3.0 * it * t * t) + p[3] * (t * t * t);
+    }
+    
+    const T& p0 = points_[span == 0 ? 0 : span - 1];
+    const T& p1 = points_[span];
+    const T& p2 = points_[span + 1];
+    const T& p3 = points_[span + 2 < points_.size() ? span + 2 : span + 1];
+    double t2 = t * t, t3 = t2 * t;
+    return (p1 * 2.0 + 
+            (p2 - p0) * t + 
+            (p0 * 2.0 - p1 * 5.0 + p2 * 4.0 - p3) * t2 + 
+            (p1 * 3.0 - p0 - p2 * 3.0 + p3) * t3) * 0.5;
+  }
+  
+  // ------ build(): sample by parameter, then invert to uniform arc length ---
+  void build(int resolution) {
+    const size_t samples = size_t(resolution) * 4;
+    std::vector<double> lengths(samples + 1, 0.0);
+    
+    T prev = point(0);
+    for (size_t i = 1; i <= samples; i++) {
+      T cur = point(double(spans_) * i / samples);
+      lengths[i] = lengths[i - 1] + valueDistance(prev, cur);
+      prev = cur;
+    }
+    length_ = lengths[samples];
+    
+    params_.resize(size_t(resolution) + 1);
+    size_t k = 0;
+    for (size_t j = 0; j <= size_t(resolution); j++) {
+      double target = length_ * j / resolution;
+      while (k < samples - 1 && lengths[k + 1] < target) k++;
+      
+      double seg = lengths[k + 1] - lengths[k];
+      double f = (seg > 0) ? (target - lengths[k]) / seg : 0;
+      if (f > 1) f = 1;
+      params_[j] = float(double(spans_) * (k + f) / samples);
+    }
+  }
+  
+ private:
+  Type               type_;
+  std::vector<T>     points_;
+  size_t             spans_;
+  double             length_;
+  std::vector<float> params_; // curve parameter at uniform arc-length steps
+};
+
+
+/*=============================================================================
+          pathAnimation: eases progress along a Path
+=============================================================================*/
+template <typename T>
+class pathAnimation : public AnimationBase<double>
+{
+ public:
+  pathAnimation (T* var, const Path<T>* path,
+                 double duration,
+                 double (*easing)(double t, double b, double c, double d),
+                 TimeBase* timer)
+        : AnimationBase<double>(duration, 1, easing, timer), 
+          var_(var), path_(path) {}
+  
+  pathAnimation<T>* setFinalValue(double finalVal) {
+    this->final_val_ = finalVal;
+    return this;
+  }
+  
+  // ------ Custom update for paths -------------------------------------------
+  void update(const double ttime) {
+    if (isDelaying(ttime))
+      return;
+    
+    // ------ Set beginning values --------------------------------------------
+    if (!this->started_) {
+      callbackStart();
+      this->started_ = true;
+      this->start_ = ttime;
+      this->beginning_ = 0;
+      this->change_ = this->final_val_;
+    }
+    
+    *var_ = path_->at(this->updateVar(ttime));
+    
+    callbackStep();
+    callbackFinish();
+  }
+  
+ protected:
+  double sampleBeginning() const {
+    return 0; // samples are progress along the path, path_->at() them
+  }
+  
+ private:
+  T*             var_;
+  const Path<T>* path_;
+};
+
+
+/*=============================================================================
+          pathAnimator: moves a variable along a Path
+=============================================================================*/
+template <typename T>
+class pathAnimator : public AnimatorImpl<double>
+{
+ public:
+  pathAnimator (T* var, const Path<T>* path) : var_(var), path_(path) { 
+    this->init(); 
+  }
+  
+  // ------ Setup new Animation -----------------------------------------------
+  pathAnimator<T>* anim(double duration) {
+    this->initialAnim_ = new pathAnimation<T>(var_, path_, duration,
+                                              Ease::NoneLinear, new Timing::Linear());
+    return this;
+  }
+  
+  // ------ All in one method -------------------------------------------------
+  pathAnimator<T>* go(double duration, 
+                      double (*easingMethod)(double t, double b, double c, double d) = Ease::NoneLinear,
+                      TimeBase* timeMethod = new Timing::Linear()) 
+  {
+    this->queue(new pathAnimation<T>(var_, path_, duration,
+                                     easingMethod, timeMethod));
+    return this;
+  }
+  
+ protected:
+  AnimationBase<double>* makeAnimation() {
+    return new pathAnimation<T>(var_, path_, 0, Ease::NoneLinear, 0);
+  }
+  
+ protected:
+  T*             var_;
+  const Path<T>* path_;
+};
+
+} // namespace rp
@@ -0,0 +1,248 @@
+//  ------------------------------------------------------------------------ // 
+//  ===== Pool.h =========================================================== // 
+//  ------------------------------------------------------------------------ // 
+//   Created:        Kevin Webster                                           // 
+//   Date:           26.10.19                                                // 
+//   Copyright (c)   2010 All rights reserved.                               // 
+//  ------------------------------------------------------------------------ // 
+//  Redistribution and use in source and binary forms, with or without       // 
+//  modification, are permitted provided that the following conditions       // 
+//  are met:                                                                 // 
+//                                                                           // 
+//     * Redistributions of source code must retain the above copyright      // 
+//       notice, this list of conditions and the following disclaimer.       // 
+//     * Redistributions in binary form must reproduce the above copyright   // 
+//       notice, this list of conditions and the following disclaimer in     // 
+//       the documentation and/or other materials provided with the          // 
+//       distribution.                                                       // 
+//     * Stealing is also kinda lame.                                        // 
+//                                                                           // 
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS      // 
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT        // 
+//  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR    // 
+//  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT     // 
+//  HOLDER OR CONTRIBUTORS BE LIABLEFOR ANY DIRECT, INDIRECT, INCIDENTAL,    // 
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED // 
+//  TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR   // 
+//  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF   // 
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING     // 
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS       // 
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.             // 
+//  ------------------------------------------------------------------------ // 
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+#if __cplusplus >= 201103L
+#include <mutex>
+#endif
+
+#if __cplusplus >= 201103L
+#define ANI_THREAD_LOCAL thread_local
+#elif defined(__GNUC__)
+#define ANI_THREAD_LOCAL __thread
+#else
+#define ANI_THREAD_LOCAL
+#endif
+
+namespace rp {
+
+/*=============================================================================
+          Pool: size classed free lists
+===============================================================================
+
+  Every go() used to cost a couple of trips to the heap, every finished 
+  animation a couple more. Animations, timers, callbacks, animators and the
+  containers holding them now recycle their memory through here instead, so
+  a warmed up Ani stops touching the heap altogether.
+  
+  Blocks are never handed back to the system, the pool settles at the high
+  water mark. Free lists are per thread. With C++11 a list that grows past 
+  Spill blocks moves half of them onto a locked shared list, and a thread 
+  that runs dry refills from there before going to the heap. So blocks 
+  allocated on one thread and freed on another, the way a Scheduler's 
+  workers finish what go() started on the main thread, flow back instead 
+  of piling up. A thread's lists join the shared one when it exits.
+  
+*/
+class Pool
+{
+ public:
+  enum { Granularity = 16, Classes = 64 }; // blocks up to 1k
+  enum { Spill = 64, Batch = Spill / 2 };  // per thread, per class
+  
+  static void* allocate(std::size_t size) {
+    std::size_t c = sizeClass(size);
+    if (c >= Classes) 
+      return ::operator new(size);
+    
+    Lists& l = lists();
+    if (!l.heads[c]) 
+      refill(l, c);
+    if (Node* n = l.heads[c]) {
+      l.heads[c] = n->next;
+      l.counts[c]--;
+      return n;
+    }
+    return ::operator new((c + 1) * Granularity);
+  }
+  
+  static void release(void* p, std::size_t size) {
+    if (!p) 
+      return;
+    std::size_t c = sizeClass(size);
+    if (c >= Classes) {
+      ::operator delete(p);
+      return;
+    }
+    Lists& l = lists();
+    Node* n = static_cast<Node*>(p);
+    n->next = l.heads[c];
+    l.heads[c] = n;
+    if (++l.counts[c] > Spill) 
+      spill(l, c, Batch);
+  }
+  
+ private:
+  struct Node { Node* next; };
+  
+  struct Lists
+  {
+    Node*       heads[Classes];
+    std::size_t counts[Classes];
+#if __cplusplus >= 201103L
+    ~Lists () {
+      for (std::size_t c = 0; c < Classes; c++) {
+        spill(*this, c, counts[c]);
+      }
+    }
+#endif
+  };
+  
+  static std::size_t sizeClass(std::size_t size) {
+    return size ? (size - 1) / Granularity : 0;
+  }
+  
+#if __cplusplus >= 201103L
+  static Lists& lists() {
+    static thread_local Lists lists = Lists();
+    return lists;
+  }
+  
+  // ------ Shared list: where threads leave their surplus -------------------
+  struct Shared
+  {
+    std::mutex lock;
+    Node*      heads[Classes];
+  };
+  static Shared& shared() {
+    static Shared shared;  // heads start out zeroed like any static
+    return shared;
+  }
+  
+  // ------ spill(): n blocks off the front of l's list onto the shared one --
+  static void spill(Lists& l, std::size_t c, std::size_t n) {
+    if (!n) 
+      return;
+    Node* first = l.heads[c];
+    Node* last  = first;
+    for (std::size_t i = 1; i < n; i++) {
+      last = last->next;
+    }
+    l.heads[c]   = last->next;
+    l.counts[c] -= n;
+    
+    Shared& s = shared();
+    std::lock_guard<std::mutex> guard(s.lock);
+    last->next = s.heads[c];
+    s.heads[c] = first;
+  }
+  
+  // ------ refill(): up to Batch blocks back from the shared list -----------
+  static void refill(Lists& l, std::size_t c) {
+    Shared& s = shared();
+    std::lock_guard<std::mutex> guard(s.lock);
+    Node* first = s.heads[c];
+    if (!first) 
+      return;
+    Node* last = first;
+    std::size_t n = 1;
+    for (; n < Batch && last->next; n++) {
+      last = last->next;
+    }
+    s.heads[c]   = last->next;
+    last->next   = l.heads[c];
+    l.heads[c]   = first;
+    l.counts[c] += n;
+  }
+#else
+  static Lists& lists() {
+    static ANI_THREAD_LOCAL Lists lists;
+    return lists;
+  }
+  // No shared list without C++11 threads, every list keeps what it's given
+  static void spill(Lists&, std::size_t, std::size_t) {}
+  static void refill(Lists&, std::size_t) {}
+#endif
+};
+
+/*
+  Inherit to allocate a class (and everything derived from it) from the Pool,
+  polymorphic deletes need a virtual destructor so the right size comes back
+*/
+class Pooled
+{
+ public:
+  static void* operator new(std::size_t size) { 
+    return Pool::allocate(size); 
+  }
+  static void operator delete(void* p, std::size_t size) { 
+    Pool::release(p, size); 
+  }
+};
+
+/*=============================================================================
+          PoolAllocator: std container allocator on top of the Pool
+=============================================================================*/
+template <typename T>
+class PoolAllocator
+{
+ public:
+  typedef T              value_type;
+  typedef T*             pointer;
+  typedef const T*       const_pointer;
+  typedef T&             reference;
+  typedef const T&       const_reference;
+  typedef std::size_t    size_type;
+  typedef std::ptrdiff_t difference_type;
+  
+  template <typename U> 
+  struct rebind { typedef PoolAllocator<U> other; };
+  
+  PoolAllocator () {}
+  template <typename U> 
+  PoolAllocator (const PoolAllocator<U>&) {}
+  
+  pointer allocate(size_type n, const void* = 0) {
+    return static_cast<pointer>(Pool::allocate(n * sizeof(T)));
+  }
+  void deallocate(pointer p, size_type n) {
+    Pool::release(p, n * sizeof(T));
+  }
+  
+  void construct(pointer p, const T& val) { new (p) T(val); }
+  void destroy(pointer p) { p->~T(); }
+  
+  pointer address(reference x) const { return &x; }
+  const_pointer address(const_reference x) const { return &x; }
+  size_type max_size() const { return size_type(-1) / sizeof(T); }
+  
+  template <typename U> 
+  bool operator==(const PoolAllocator<U>&) const { return true; }
+  template <typename U> 
+  bool operator!=(const PoolAllocator<U>&) const { return false; }
+};
+
+} // namespace rp
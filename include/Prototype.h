@@ -0,0 +1,223 @@
+//  ------------------------------------------------------------------------ // 
+//  ===== Prototype.h ====================================================== // 
+//  ------------------------------------------------------------------------ // 
+//   Created:        Kevin Webster                                           // 
+//   Date:           26.10.19                                                // 
+//   Copyright (c)   2010 All rights reserved.                               // 
+//  ------------------------------------------------------------------------ // 
+//  Redistribution and use in source and binary forms, with or without       // 
+//  modification, are permitted provided that the following conditions       // 
+//  are met:                                                                 // 
+//                                                                           // 
+//     * Redistributions of source code must retain the above copyright      // 
+//       notice, this list of conditions and the following disclaimer.       // 
+//     * Redistributions in binary form must reproduce the above copyright   // 
+//       notice, this list of conditions and the following disclaimer in     // 
+//       the documentation and/or other materials provided with the          // 
+//       distribution.                                                       // 
+//     * Stealing is also kinda lame.                                        // 
+//                                                                           // 
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS      // 
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT        // 
+//  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR    // 
+//  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT     // 
+//  HOLDER OR CONTRIBUTORS BE LIABLEFOR ANY DIRECT, INDIRECT, INCIDENTAL,    // 
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED // 
+//  TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR   // 
+//  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF   // 
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING     // 
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS       // 
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.             // 
+//  ------------------------------------------------------------------------ // 
+
+#pragma once
+
+#include <vector>
+
+#include "Ease.h"
+#include "Timing.h"
+#include "Value.h"
+#include "Animator.h"
+
+namespace rp {
+
+/*
+// ====== Animation Prototypes ================================================
+Starting the same style of tween over and over with go() builds a complete
+Animation<T> every time: duration, easing, a fresh TimeBase, delay and the
+callback slots, all copied into each one.
+
+A prototypeAnimator holds that shared part once and is immutable. Its 
+instances carry only what differs, the target, start time and begin/change
+values:
+
+  prototypeAnimator<float>* fadeIn = ani.prototype(
+    AnimationStyle<float>(.3, Ease::OutCubic));
+  fadeIn->go(&alpha, 1);
+
+To change a style for future instances only, derive a new prototype from
+it, the running ones carry on with the old:
+
+  fadeIn = ani.prototype(fadeIn->derive().setDuration(.5));
+
+Like compact records, instances have no callbacks and pick up their begin
+value on the first update, before any delay.
+
+*/
+template <typename T>
+struct AnimationStyle
+{
+  AnimationStyle (double d = 1, 
+                  T (*e)(double t, T b, T c, double d) = Ease::NoneLinear,
+                  TimingKind::Type t = TimingKind::Linear,
+                  int r = 0)
+    : duration(d), easing(e), timing(t), repeats(r), delay(0) {}
+  
+  AnimationStyle<T>& setDuration(double d) { duration = d; return *this; }
+  AnimationStyle<T>& setEasingMethod(T (*e)(double t, T b, T c, double d)) { 
+    easing = e; 
+    return *this; 
+  }
+  AnimationStyle<T>& setTiming(TimingKind::Type t, int r = 0) { 
+    timing = t; 
+    repeats = r; 
+    return *this; 
+  }
+  AnimationStyle<T>& setDelay(double d) { delay = d; return *this; }
+  
+  double           duration;
+  T              (*easing)(double t, T b, T c, double d);
+  TimingKind::Type timing;
+  int              repeats; // 0 repeats forever
+  double           delay;
+};
+
+template <typename T>
+struct PrototypeInstance
+{
+  T*     var;
+  double start;
+  T      beginning;
+  T      change;    // holds the final value until the instance has started
+};
+
+
+/*=============================================================================
+          prototypeAnimator: a shared style and the instances playing it
+=============================================================================*/
+template <typename T>
+class prototypeAnimator : public Animator
+{
+ public:
+  prototypeAnimator (const AnimationStyle<T>& style) : style_(style) {
+    switch (style.timing) {
+      case TimingKind::Repeat:
+        timer_ = style.repeats ? new Timing::Repeat(style.repeats) 
+                               : new Timing::Repeat();
+        break;
+      case TimingKind::PingPong:
+        timer_ = style.repeats ? new Timing::PingPong(style.repeats) 
+                               : new Timing::PingPong();
+        break;
+      default:
+        timer_ = new Timing::Linear();
+    }
+  }
+  ~prototypeAnimator () { delete timer_; }
+  
+  // ------ go(): start an instance from the variable's current value --------
+  prototypeAnimator<T>* go(T* var, T finalVal) {
+    PrototypeInstance<T> inst;
+    inst.var       = var;
+    inst.start     = 0;
+    inst.beginning = *var;
+    inst.change    = finalVal;
+    starting_.push_back(inst);
+    return this;
+  }
+  
+  // ------ derive(): a copy of the style to build a new prototype from -------
+  AnimationStyle<T> derive() const {
+    return style_;
+  }
+  const AnimationStyle<T>& getStyle() const {
+    return style_;
+  }
+  
+  // ------ Buttons -----------------------------------------------------------
+  prototypeAnimator<T>* stop(T* var) {
+    drop(starting_, var);
+    drop(instances_, var);
+    return this;
+  }
+  prototypeAnimator<T>* stop() {
+    starting_.clear();
+    instances_.clear();
+    return this;
+  }
+  
+  // ------ Queries -----------------------------------------------------------
+  bool isAnimating() {
+    return size() > 0;
+  }
+  size_t size() {
+    return starting_.size() + instances_.size();
+  }
+  size_t activeCount() {
+    return size();
+  }
+  
+  // ------ Updater -----------------------------------------------------------
+  void update(const double ttime) {
+    for (size_t i = 0; i < starting_.size(); i++) {
+      PrototypeInstance<T>& inst = starting_[i];
+      inst.start     = ttime + style_.delay;
+      inst.beginning = *inst.var;
+      inst.change    = EaseTraits<T>::change(*inst.var, inst.change);
+      instances_.push_back(inst);
+    }
+    starting_.clear();
+    
+    for (size_t i = 0; i < instances_.size(); ) {
+      PrototypeInstance<T>& inst = instances_[i];
+      if (ttime < inst.start) { // delaying
+        ++i;
+        continue;
+      }
+      
+      bool finished = false;
+      double nT = timer_->progress(ttime, inst.start, style_.duration, finished);
+      *inst.var = style_.easing(nT, inst.beginning, inst.change, 1);
+      EaseTraits<T>::normalize(*inst.var);
+      
+      if (finished) {
+        inst = instances_.back();
+        instances_.pop_back();
+      } else {
+        ++i;
+      }
+    }
+  }
+  
+ protected:
+  typedef std::vector<PrototypeInstance<T> > Instances;
+  
+  static void drop(Instances& instances, T* var) {
+    for (size_t i = 0; i < instances.size(); ) {
+      if (instances[i].var == var) {
+        instances[i] = instances.back();
+        instances.pop_back();
+      } else {
+        ++i;
+      }
+    }
+  }
+  
+ protected:
+  const AnimationStyle<T> style_;
+  TimeBase*               timer_;     // only progress() is used, so it's shared
+  Instances               starting_;  // go() since the last update
+  Instances               instances_;
+};
+
+} // namespace rp
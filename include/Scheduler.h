@@ -0,0 +1,318 @@
+//  ------------------------------------------------------------------------ // 
+//  ===== Scheduler.h ====================================================== // 
+//  ------------------------------------------------------------------------ // 
+//   Created:        Kevin Webster                                           // 
+//   Date:           26.10.19                                                // 
+//   Copyright (c)   2010 All rights reserved.                               // 
+//  ------------------------------------------------------------------------ // 
+//  Redistribution and use in source and binary forms, with or without       // 
+//  modification, are permitted provided that the following conditions       // 
+//  are met:                                                                 // 
+//                                                                           // 
+//     * Redistributions of source code must retain the above copyright      // 
+//       notice, this list of conditions and the following disclaimer.       // 
+//     * Redistributions in binary form must reproduce the above copyright   // 
+//       notice, this list of conditions and the following disclaimer in     // 
+//       the documentation and/or other materials provided with the          // 
+//       distribution.                                                       // 
+//     * Stealing is also kinda lame.                                        // 
+//                                                                           // 
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS      // 
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT        // 
+//  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR    // 
+//  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT     // 
+//  HOLDER OR CONTRIBUTORS BE LIABLEFOR ANY DIRECT, INDIRECT, INCIDENTAL,    // 
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED // 
+//  TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR   // 
+//  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF   // 
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING     // 
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS       // 
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.             // 
+//  ------------------------------------------------------------------------ // 
+
+#pragma once
+
+/*
+// ====== Scheduler ===========================================================
+Drives many Ani instances, one per scene or session, from a shared pool of 
+worker threads. Needs C++11 threads.
+
+Every registered Ani gets a priority and a tick rate. Each update() picks 
+the ones that are due, spreads them over the workers by how many 
+animations they had playing last pass (longest first, onto the least 
+loaded worker) and returns when all of them are done:
+
+  Scheduler scheduler(4);
+  scheduler.add(&menu, 0, 30);    // 30 ticks a second
+  scheduler.add(&world, 10);      // every update, ahead of the rest
+  ...
+  scheduler.update(t);
+
+stats() returns a copy of what each Ani costs, so a busy one can be spotted
+and throttled with setRate() before it starves the rest.
+
+An Ani is only ever updated by one thread at a time, but that's a worker:
+callbacks run there, and nothing may touch a registered Ani while update()
+is running.
+
+*/
+
+#if __cplusplus >= 201103L
+
+#define ANI_HAS_SCHEDULER 1
+
+#include <stdint.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Ani.h"
+
+namespace rp {
+
+struct SchedulerStats
+{
+  Ani*     ani;
+  int      priority;  // higher goes first on its worker
+  double   rate;      // updates per time unit, 0 for every update()
+  size_t   active;    // animations playing after its last update
+  double   lastCost;  // seconds spent in its last update
+  double   avgCost;   // moving average of the above
+  double   maxCost;
+  uint64_t updates;
+};
+
+/*=============================================================================
+          Scheduler: many Anis on a worker pool
+=============================================================================*/
+class Scheduler
+{
+ public:
+  // The calling thread works too, threads counts it
+  Scheduler (size_t threads = std::thread::hardware_concurrency()) : 
+    generation_(0), 
+    pending_(0), 
+    stopping_(false) 
+  {
+    lanes_.resize(threads ? threads : 1);
+    for (size_t i = 1; i < lanes_.size(); i++) {
+      workers_.push_back(std::thread(&Scheduler::work, this, i));
+    }
+  }
+  ~Scheduler () {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopping_ = true;
+    }
+    wake_.notify_all();
+    for (size_t i = 0; i < workers_.size(); i++) {
+      workers_[i].join();
+    }
+  }
+  
+  // ------ add(): register an Ani, rate 0 updates it on every update() ------
+  void add(Ani* ani, int priority = 0, double rate = 0) {
+    Entry e;
+    e.stats.ani      = ani;
+    e.stats.priority = priority;
+    e.stats.rate     = rate;
+    e.stats.active   = 0;
+    e.stats.lastCost = 0;
+    e.stats.avgCost  = 0;
+    e.stats.maxCost  = 0;
+    e.stats.updates  = 0;
+    e.next           = -HUGE_VAL;
+    entries_.push_back(e);
+    ani->countActive();
+  }
+  void remove(Ani* ani) {
+    for (size_t i = 0; i < entries_.size(); i++) {
+      if (entries_[i].stats.ani == ani) {
+        ani->countActive(false);
+        entries_.erase(entries_.begin() + i);
+        return;
+      }
+    }
+  }
+  
+  void setRate(Ani* ani, double rate) {
+    if (Entry* e = find(ani)) 
+      e->stats.rate = rate;
+  }
+  void setPriority(Ani* ani, int priority) {
+    if (Entry* e = find(ani)) 
+      e->stats.priority = priority;
+  }
+  
+  // ------ update(): update every due Ani, returns once they're all done -----
+  // Returns how many were updated
+  size_t update(const double ttime) {
+    // ------ Due ones, heaviest first ----------------------------------------
+    due_.clear();
+    for (size_t i = 0; i < entries_.size(); i++) {
+      Entry& e = entries_[i];
+      if (ttime < e.next) 
+        continue;
+      if (e.stats.rate > 0) {
+        e.next += 1 / e.stats.rate;
+        if (e.next <= ttime) // skip missed ticks rather than bunch them up
+          e.next = ttime + 1 / e.stats.rate;
+      }
+      due_.push_back(&e);
+    }
+    std::sort(due_.begin(), due_.end(), Heavier());
+    
+    // ------ Longest processing time first, onto the least loaded lane -------
+    for (size_t l = 0; l < lanes_.size(); l++) {
+      lanes_[l].jobs.clear();
+      lanes_[l].load = 0;
+    }
+    for (size_t i = 0; i < due_.size(); i++) {
+      Lane* lightest = &lanes_[0];
+      for (size_t l = 1; l < lanes_.size(); l++) {
+        if (lanes_[l].load < lightest->load) 
+          lightest = &lanes_[l];
+      }
+      lightest->jobs.push_back(due_[i]);
+      lightest->load += weight(*due_[i]);
+    }
+    for (size_t l = 0; l < lanes_.size(); l++) {
+      byPriority(lanes_[l].jobs);
+    }
+    
+    // ------ Hand out the lanes, run lane 0 here -----------------------------
+    time_ = ttime;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      pending_ = lanes_.size() - 1;
+      generation_++;
+    }
+    wake_.notify_all();
+    run(lanes_[0]);
+    
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this] { return pending_ == 0; });
+    return due_.size();
+  }
+  
+  // ------ Queries -----------------------------------------------------------
+  // A copy, entries move when others are added or removed. Zeroed, with a 
+  // null ani, if ani isn't registered.
+  SchedulerStats stats(Ani* ani) {
+    Entry* e = find(ani);
+    if (e) 
+      return e->stats;
+    SchedulerStats none = SchedulerStats();
+    return none;
+  }
+  size_t size() {
+    return entries_.size();
+  }
+  size_t threads() {
+    return lanes_.size();
+  }
+  
+ private:
+  struct Entry
+  {
+    SchedulerStats stats;
+    double         next; // earliest time of its next update
+  };
+  
+  struct Lane
+  {
+    std::vector<Entry*> jobs;
+    size_t              load;
+  };
+  
+  // Idle Anis still walk their animators
+  static size_t weight(const Entry& e) {
+    return e.stats.active + 1;
+  }
+  struct Heavier {
+    bool operator()(const Entry* a, const Entry* b) const {
+      return weight(*a) > weight(*b);
+    }
+  };
+  struct Before {
+    bool operator()(const Entry* a, const Entry* b) const {
+      return a->stats.priority > b->stats.priority;
+    }
+  };
+  
+  // Stable insertion sort, std::stable_sort would allocate every update()
+  static void byPriority(std::vector<Entry*>& jobs) {
+    for (size_t i = 1; i < jobs.size(); i++) {
+      Entry* e = jobs[i];
+      size_t j = i;
+      for (; j > 0 && Before()(e, jobs[j - 1]); j--) {
+        jobs[j] = jobs[j - 1];
+      }
+      jobs[j] = e;
+    }
+  }
+  
+  Entry* find(Ani* ani) {
+    for (size_t i = 0; i < entries_.size(); i++) {
+      if (entries_[i].stats.ani == ani) 
+        return &entries_[i];
+    }
+    return 0;
+  }
+  
+  void run(Lane& lane) {
+    typedef std::chrono::steady_clock clock;
+    for (size_t i = 0; i < lane.jobs.size(); i++) {
+      SchedulerStats& s = lane.jobs[i]->stats;
+      clock::time_point begin = clock::now();
+      s.ani->update(time_);
+      double cost = std::chrono::duration<double>(clock::now() - begin).count();
+      
+      s.active   = s.ani->getActiveCount();
+      s.lastCost = cost;
+      s.avgCost  = s.updates ? s.avgCost + (cost - s.avgCost) * 0.1 : cost;
+      s.maxCost  = std::max(s.maxCost, cost);
+      s.updates++;
+    }
+  }
+  
+  void work(size_t lane) {
+    uint64_t seen = 0;
+    for (;;) {
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        wake_.wait(lock, [&] { return stopping_ || generation_ != seen; });
+        if (stopping_) 
+          return;
+        seen = generation_;
+      }
+      run(lanes_[lane]);
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_--;
+      }
+      done_.notify_one();
+    }
+  }
+  
+ private:
+  std::vector<Entry>  entries_;
+  std::vector<Entry*> due_;   // scratch for update()
+  std::vector<Lane>   lanes_; // one per thread, 0 is the caller's
+  double              time_;
+  
+  std::vector<std::thread> workers_;
+  std::mutex               mutex_;
+  std::condition_variable  wake_;
+  std::condition_variable  done_;
+  uint64_t                 generation_;
+  size_t                   pending_;
+  bool                     stopping_;
+};
+
+} // namespace rp
+
+#endif
@@ -0,0 +1,313 @@
+//  ------------------------------------------------------------------------ // 
+//  ===== Shared.h ========================================================= // 
+//  ------------------------------------------------------------------------ // 
+//   Created:        Kevin Webster                                           // 
+//   Date:           26.10.19                                                // 
+//   Copyright (c)   2010 All rights reserved.                               // 
+//  ------------------------------------------------------------------------ // 
+//  Redistribution and use in source and binary forms, with or without       // 
+//  modification, are permitted provided that the following conditions       // 
+//  are met:                                                                 // 
+//                                                                           // 
+//     * Redistributions of source code must retain the above copyright      // 
+//       notice, this list of conditions and the following disclaimer.       // 
+//     * Redistributions in binary form must reproduce the above copyright   // 
+//       notice, this list of conditions and the following disclaimer in     // 
+//       the documentation and/or other materials provided with the          // 
+//       distribution.                                                       // 
+//     * Stealing is also kinda lame.                                        // 
+//                                                                           // 
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS      // 
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT        // 
+//  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR    // 
+//  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT     // 
+//  HOLDER OR CONTRIBUTORS BE LIABLEFOR ANY DIRECT, INDIRECT, INCIDENTAL,    // 
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED // 
+//  TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR   // 
+//  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF   // 
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING     // 
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS       // 
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.             // 
+//  ------------------------------------------------------------------------ // 
+
+#pragma once
+
+/*
+// ====== Shared Memory Output ================================================
+Lets animated values live in a POSIX shared memory segment, so other
+processes on the same host read them in place instead of receiving a copy
+over a socket every frame. Needs C++11 atomics and shm_open(), link with 
+-lrt on older glibc.
+
+The publisher owns the segment. Its slots are ordinary T* into a private
+frame and get mated like any other variable. update() runs the Ani pass 
+on that frame, then publishes it with one memcpy inside a seqlock write, 
+so readers only ever wait for the copy, never for the animators:
+
+  SharedPublisher<float> out("/ani_frame", 64);
+  ani.mate(out.slot(0))->go(1.0, 10, Ease::OutExpo);
+  ...
+  out.update(ani, t);
+
+Subscribers map the same name read only and copy out consistent frames 
+straight from the mapping, a read racing a publish retries instead of 
+returning a torn frame:
+
+  SharedSubscriber<float> in("/ani_frame");
+  std::vector<float> frame(in.size());
+  uint64_t n;
+  if (in.read(&frame[0], frame.size(), &n)) ...
+
+T has to be plain old data, the bytes are shared as they are. One 
+publisher per segment.
+
+*/
+
+#if __cplusplus >= 201103L && (defined(__unix__) || defined(__APPLE__))
+
+#define ANI_HAS_SHARED 1
+
+#include <stdint.h>
+#include <atomic>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Ani.h"
+
+namespace rp {
+
+/*=============================================================================
+          SharedHeader: start of every segment
+=============================================================================*/
+struct SharedHeader
+{
+  enum { Magic = 0x48534e41, Version = 1 }; // "ANSH"
+  
+  uint32_t              magic;
+  uint32_t              version;
+  uint32_t              count;     // slots
+  uint32_t              valueSize; // sizeof(T) on the publishing side
+  std::atomic<uint64_t> seq;       // odd while a frame is being written
+  
+  // Values start on their own cache line, away from the sequence counter
+  static size_t offset() { return 64; }
+};
+
+/*=============================================================================
+          SharedSegment: shm_open() & mmap() wrapper
+=============================================================================*/
+class SharedSegment
+{
+ public:
+  SharedSegment () : base_(0), size_(0) {}
+  ~SharedSegment () { close(); }
+  
+  // ------ create(): new segment, replaces a stale one with the same name ----
+  bool create(const char* name, size_t size) {
+    close();
+    int fd = shm_open(name, O_CREAT | O_RDWR | O_TRUNC, 0644);
+    if (fd < 0) 
+      return false;
+    if (ftruncate(fd, off_t(size)) != 0) {
+      ::close(fd);
+      return false;
+    }
+    return map(fd, size, PROT_READ | PROT_WRITE);
+  }
+  
+  // ------ open(): existing segment, read only -------------------------------
+  bool open(const char* name) {
+    close();
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) 
+      return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || size_t(st.st_size) < SharedHeader::offset()) {
+      ::close(fd);
+      return false;
+    }
+    return map(fd, size_t(st.st_size), PROT_READ);
+  }
+  
+  void close() {
+    if (base_) 
+      munmap(base_, size_);
+    base_ = 0;
+    size_ = 0;
+  }
+  
+  static void unlink(const char* name) {
+    shm_unlink(name);
+  }
+  
+  char*  data() const { return static_cast<char*>(base_); }
+  size_t size() const { return size_; }
+  
+ private:
+  bool map(int fd, size_t size, int prot) {
+    void* p = mmap(0, size, prot, MAP_SHARED, fd, 0);
+    ::close(fd); // the mapping keeps the segment alive
+    if (p == MAP_FAILED) 
+      return false;
+    base_ = p;
+    size_ = size;
+    return true;
+  }
+  
+  SharedSegment (const SharedSegment&);
+  SharedSegment& operator=(const SharedSegment&);
+  
+  void*  base_;
+  size_t size_;
+};
+
+/*=============================================================================
+          SharedPublisher: writes frames of T into a segment
+=============================================================================*/
+template <typename T>
+class SharedPublisher
+{
+ public:
+  SharedPublisher (const char* name, size_t count) : 
+    name_(name), 
+    header_(0), 
+    values_(0), 
+    count_(0) 
+  {
+    if (!segment_.create(name, SharedHeader::offset() + count * sizeof(T))) 
+      return;
+    
+    header_ = new (segment_.data()) SharedHeader();
+    header_->magic     = SharedHeader::Magic;
+    header_->version   = SharedHeader::Version;
+    header_->count     = uint32_t(count);
+    header_->valueSize = uint32_t(sizeof(T));
+    header_->seq.store(0, std::memory_order_release);
+    
+    values_ = reinterpret_cast<T*>(segment_.data() + SharedHeader::offset());
+    count_  = count;
+    frame_.assign(count, T());
+  }
+  ~SharedPublisher () {
+    segment_.close();
+    SharedSegment::unlink(name_.c_str());
+  }
+  
+  // ------ slot(): address to mate(), in the private frame ------------------
+  T* slot(size_t i) {
+    return &frame_[i];
+  }
+  
+  // ------ publish(): copy the private frame out, the only locked part -------
+  void publish() {
+    if (!header_) 
+      return;
+    uint64_t s = header_->seq.load(std::memory_order_relaxed);
+    header_->seq.store(s + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    
+    if (count_) 
+      std::memcpy(values_, &frame_[0], count_ * sizeof(T));
+    
+    header_->seq.store(s + 2, std::memory_order_release);
+  }
+  
+  // ------ update(): one Ani pass as one frame -------------------------------
+  void update(Ani& ani, const double ttime) {
+    ani.update(ttime);
+    publish();
+  }
+  
+  // ------ Queries -----------------------------------------------------------
+  bool   isOpen() const { return header_ != 0; }
+  size_t size() const { return count_; }
+  uint64_t frame() const { return header_->seq.load(std::memory_order_relaxed) / 2; }
+  
+ private:
+  SharedPublisher (const SharedPublisher&);
+  SharedPublisher& operator=(const SharedPublisher&);
+  
+  std::string   name_;
+  SharedSegment segment_;
+  SharedHeader* header_;
+  T*            values_;  // in the segment
+  size_t        count_;
+  std::vector<T> frame_;  // what the animators write
+};
+
+/*=============================================================================
+          SharedSubscriber: reads consistent frames from another process
+=============================================================================*/
+template <typename T>
+class SharedSubscriber
+{
+ public:
+  SharedSubscriber () : header_(0), values_(0), count_(0) {}
+  SharedSubscriber (const char* name) : header_(0), values_(0), count_(0) {
+    open(name);
+  }
+  
+  bool open(const char* name) {
+    header_ = 0;
+    if (!segment_.open(name)) 
+      return false;
+    
+    const SharedHeader* h = reinterpret_cast<const SharedHeader*>(segment_.data());
+    if (h->magic != SharedHeader::Magic || h->version != SharedHeader::Version ||
+        h->valueSize != sizeof(T) || 
+        segment_.size() < SharedHeader::offset() + h->count * sizeof(T)) 
+    {
+      segment_.close();
+      return false;
+    }
+    header_ = h;
+    values_ = reinterpret_cast<const T*>(segment_.data() + SharedHeader::offset());
+    count_  = h->count;
+    return true;
+  }
+  
+  // ------ read(): copy of the first n slots of the latest complete frame ----
+  // False if the publisher kept writing for all of the attempts
+  bool read(T* out, size_t n, uint64_t* frame = 0, int attempts = 1000) {
+    if (!header_ || n > count_) 
+      return false;
+    
+    for (int i = 0; i < attempts; i++) {
+      uint64_t before = header_->seq.load(std::memory_order_acquire);
+      if (before & 1) 
+        continue; // mid frame
+      
+      std::memcpy(out, values_, n * sizeof(T));
+      std::atomic_thread_fence(std::memory_order_acquire);
+      
+      if (header_->seq.load(std::memory_order_relaxed) == before) {
+        if (frame) 
+          *frame = before / 2;
+        return true;
+      }
+    }
+    return false;
+  }
+  
+  // ------ Queries -----------------------------------------------------------
+  bool   isOpen() const { return header_ != 0; }
+  size_t size() const { return count_; }
+  uint64_t frame() const { return header_->seq.load(std::memory_order_acquire) / 2; }
+  
+ private:
+  SharedSegment       segment_;
+  const SharedHeader* header_;
+  const T*            values_;
+  size_t              count_;
+};
+
+} // namespace rp
+
+#endif
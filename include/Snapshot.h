@@ -0,0 +1,208 @@
+//  ------------------------------------------------------------------------ // 
+//  ===== Snapshot.h ======================================================= // 
+//  ------------------------------------------------------------------------ // 
+//   Created:        Kevin Webster                                           // 
+//   Date:           26.10.19                                                // 
+//   Copyright (c)   2010 All rights reserved.                               // 
+//  ------------------------------------------------------------------------ // 
+//  Redistribution and use in source and binary forms, with or without       // 
+//  modification, are permitted provided that the following conditions       // 
+//  are met:                                                                 // 
+//                                                                           // 
+//     * Redistributions of source code must retain the above copyright      // 
+//       notice, this list of conditions and the following disclaimer.       // 
+//     * Redistributions in binary form must reproduce the above copyright   // 
+//       notice, this list of conditions and the following disclaimer in     // 
+//       the documentation and/or other materials provided with the          // 
+//       distribution.                                                       // 
+//     * Stealing is also kinda lame.                                        // 
+//                                                                           // 
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS      // 
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT        // 
+//  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR    // 
+//  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT     // 
+//  HOLDER OR CONTRIBUTORS BE LIABLEFOR ANY DIRECT, INDIRECT, INCIDENTAL,    // 
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED // 
+//  TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR   // 
+//  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF   // 
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING     // 
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS       // 
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.             // 
+//  ------------------------------------------------------------------------ // 
+
+#pragma once
+
+#include <stdint.h>
+#include <cstring>
+#include <map>
+#include <vector>
+
+#include "Events.h"
+
+namespace rp {
+
+class Animator;
+
+/*
+// ====== Snapshots ===========================================================
+Ani::save() writes the complete in-flight state of every bound animator 
+into one flat buffer, Ani::restore() puts it back in a single pass. Values
+are stored as raw bytes, so animated types have to be plain old data and
+snapshots only travel between builds of the same program.
+
+Pointers don't survive a restart, a SnapshotResolver translates them to 
+stable ids and back:
+
+  * animators are matched by id, recreate them with mate() as usual and
+    bind them before restoring
+  * compact and spring targets go through targetId()/target()
+  * callbacks are rebuilt from the animation's event id and kind
+
+Unbound animators are left out of the snapshot, unknown ids are skipped on
+restore. Custom TimeBase classes come back as Timing::Linear, easing 
+methods other than Ease and EaseBezier ones come back as Ease::NoneLinear.
+
+Times are stored as they were. When the restoring clock has another base,
+pass how far it runs ahead and every start, delay and origin moves along:
+
+  ani.restore(reader, resolver, now - savedAt);
+
+*/
+
+/*=============================================================================
+          SnapshotWriter / SnapshotReader: flat byte buffers
+=============================================================================*/
+class SnapshotWriter
+{
+ public:
+  template <typename V>
+  void write(const V& v) {
+    writeBytes(&v, sizeof(V));
+  }
+  void writeBytes(const void* p, size_t n) {
+    const char* c = static_cast<const char*>(p);
+    data_.insert(data_.end(), c, c + n);
+  }
+  
+  // ------ Length prefixed blocks, so readers can skip what they don't know --
+  size_t beginBlock() {
+    write(uint32_t(0));
+    return data_.size();
+  }
+  void endBlock(size_t mark) {
+    uint32_t n = uint32_t(data_.size() - mark);
+    std::memcpy(&data_[mark - sizeof(n)], &n, sizeof(n));
+  }
+  
+  const std::vector<char>& data() const { return data_; }
+  size_t size() const { return data_.size(); }
+  void clear() { data_.clear(); }
+  
+ private:
+  std::vector<char> data_;
+};
+
+class SnapshotReader
+{
+ public:
+  SnapshotReader (const void* data, size_t size) 
+        : data_(static_cast<const char*>(data)), size_(size), pos_(0), ok_(true) {}
+  SnapshotReader (const std::vector<char>& data) 
+        : data_(data.empty() ? 0 : &data[0]), size_(data.size()), pos_(0), ok_(true) {}
+  
+  template <typename V>
+  bool read(V& v) {
+    return readBytes(&v, sizeof(V));
+  }
+  bool readBytes(void* p, size_t n) {
+    if (!ok_ || size_ - pos_ < n) 
+      return ok_ = false;
+    std::memcpy(p, data_ + pos_, n);
+    pos_ += n;
+    return true;
+  }
+  
+  // ------ block(): reader over the next length prefixed block ---------------
+  SnapshotReader block() {
+    uint32_t n = 0;
+    if (!read(n) || size_ - pos_ < n) {
+      ok_ = false;
+      return SnapshotReader(0, 0);
+    }
+    SnapshotReader sub(data_ + pos_, n);
+    pos_ += n;
+    return sub;
+  }
+  
+  bool ok() const { return ok_; }
+  
+ private:
+  const char* data_;
+  size_t      size_;
+  size_t      pos_;
+  bool        ok_;
+};
+
+/*=============================================================================
+          SnapshotResolver: stable ids for pointers
+=============================================================================*/
+class SnapshotResolver
+{
+ public:
+  virtual ~SnapshotResolver () {}
+  
+  // ------ Animators, 0 leaves an animator out -------------------------------
+  virtual uint64_t  animatorId(const Animator* animator) = 0;
+  virtual Animator* animator(uint64_t id) = 0;
+  
+  // ------ Compact & spring targets, 0 when unknown --------------------------
+  virtual uint64_t  targetId(const void* target) { return 0; }
+  virtual void*     target(uint64_t id) { return 0; }
+  
+  // ------ Callbacks, a fresh callback the animation will own ----------------
+  virtual callbackBase* callback(uint32_t eventId, EventKind::Type kind) { return 0; }
+};
+
+/*
+  Ready made resolver, bind the same ids on both sides of a restart and 
+  override callback() if animations have callbacks
+*/
+class SnapshotBinding : public SnapshotResolver
+{
+ public:
+  SnapshotBinding* bind(uint64_t id, Animator* animator) {
+    animators_[id] = animator;
+    animatorIds_[animator] = id;
+    return this;
+  }
+  SnapshotBinding* bindTarget(uint64_t id, void* target) {
+    targets_[id] = target;
+    targetIds_[target] = id;
+    return this;
+  }
+  
+  uint64_t animatorId(const Animator* animator) {
+    std::map<const Animator*, uint64_t>::iterator it = animatorIds_.find(animator);
+    return it == animatorIds_.end() ? 0 : it->second;
+  }
+  Animator* animator(uint64_t id) {
+    std::map<uint64_t, Animator*>::iterator it = animators_.find(id);
+    return it == animators_.end() ? 0 : it->second;
+  }
+  uint64_t targetId(const void* target) {
+    std::map<const void*, uint64_t>::iterator it = targetIds_.find(target);
+    return it == targetIds_.end() ? 0 : it->second;
+  }
+  void* target(uint64_t id) {
+    std::map<uint64_t, void*>::iterator it = targets_.find(id);
+    return it == targets_.end() ? 0 : it->second;
+  }
+  
+ private:
+  std::map<uint64_t, Animator*>       animators_;
+  std::map<const Animator*, uint64_t> animatorIds_;
+  std::map<uint64_t, void*>           targets_;
+  std::map<const void*, uint64_t>     targetIds_;
+};
+
+} // namespace rp
@@ -0,0 +1,337 @@
+//  ------------------------------------------------------------------------ // 
+//  ===== Spring.h ========================================================= // 
+//  ------------------------------------------------------------------------ // 
+//   Created:        Kevin Webster                                           // 
+//   Date:           26.10.19                                                // 
+//   Copyright (c)   2010 All rights reserved.                               // 
+//  ------------------------------------------------------------------------ // 
+//  Redistribution and use in source and binary forms, with or without       // 
+//  modification, are permitted provided that the following conditions       // 
+//  are met:                                                                 // 
+//                                                                           // 
+//     * Redistributions of source code must retain the above copyright      // 
+//       notice, this list of conditions and the following disclaimer.       // 
+//     * Redistributions in binary form must reproduce the above copyright   // 
+//       notice, this list of conditions and the following disclaimer in     // 
+//       the documentation and/or other materials provided with the          // 
+//       distribution.                                                       // 
+//     * Stealing is also kinda lame.                                        // 
+//                                                                           // 
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS      // 
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT        // 
+//  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR    // 
+//  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT     // 
+//  HOLDER OR CONTRIBUTORS BE LIABLEFOR ANY DIRECT, INDIRECT, INCIDENTAL,    // 
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED // 
+//  TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR   // 
+//  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF   // 
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING     // 
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS       // 
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.             // 
+//  ------------------------------------------------------------------------ // 
+
+#pragma once
+
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
+
+#include "Value.h"
+#include "Snapshot.h"
+#include "Animator.h"
+
+namespace rp {
+
+/*=============================================================================
+          springAnimator: batched damped springs
+===============================================================================
+
+  Tweens have a fixed duration so they can't be retargeted mid flight 
+  without a visible restart. A spring only has a position, a velocity and a
+  target, so retargeting is just a store.
+  
+  All springs of one type are kept in flat arrays and integrated together
+  in one pass per update. Awake springs are kept at the front of the arrays,
+  a spring that settles within epsilon of its target snaps onto it and is
+  swapped to the back where it costs nothing until it's retargeted.
+  
+  Handles stay valid until remove(), slots move around underneath them.
+  Removed handles are marked free, calls with one are ignored until add()
+  hands it out again.
+  
+    springAnimator<float>* s = ani.springs<float>();
+    uint32_t h = s->add(&var);
+    s->retarget(h, 10);
+  
+*/
+template <typename T>
+class springAnimator : public Animator
+{
+ public:
+  enum { Free = 0xffffffff }; // slot of a removed handle
+  
+  springAnimator () : awake_(0), epsilon_(0.001f), last_(0), 
+                      hasLast_(false), maxStep_(1.0f / 120) {}
+  
+  // ------ add(): start tracking a variable, at rest on its current value ----
+  uint32_t add(T* var, float stiffness = 170, float damping = 26, float mass = 1) {
+    uint32_t handle;
+    if (!free_.empty()) {
+      handle = free_.back();
+      free_.pop_back();
+    } else {
+      handle = uint32_t(slots_.size());
+      slots_.push_back(0);
+    }
+    
+    size_t i = pos_.size();
+    var_.push_back(var);
+    pos_.push_back(*var);
+    vel_.push_back(*var - *var);
+    target_.push_back(*var);
+    stiffness_.push_back(stiffness);
+    damping_.push_back(damping);
+    invMass_.push_back(1.0f / mass);
+    handles_.push_back(handle);
+    slots_[handle] = uint32_t(i);
+    return handle;
+  }
+  
+  // ------ remove(): stop tracking, the handle may be reused -----------------
+  void remove(uint32_t handle) {
+    if (!valid(handle)) 
+      return;
+    size_t i = slots_[handle];
+    if (i < awake_) {
+      swap(i, awake_ - 1);
+      i = --awake_;
+    }
+    swap(i, pos_.size() - 1);
+    
+    var_.pop_back();       pos_.pop_back();
+    vel_.pop_back();       target_.pop_back();
+    stiffness_.pop_back(); damping_.pop_back();
+    invMass_.pop_back();   handles_.pop_back();
+    slots_[handle] = Free;
+    free_.push_back(handle);
+  }
+  
+  // ------ retarget(): O(1), wakes the spring up -----------------------------
+  springAnimator<T>* retarget(uint32_t handle, T target) {
+    if (!valid(handle)) 
+      return this;
+    size_t i = slots_[handle];
+    target_[i] = target;
+    if (i >= awake_) 
+      swap(i, awake_++);
+    return this;
+  }
+  
+  // ------ General Setters ---------------------------------------------------
+  springAnimator<T>* setEpsilon(float epsilon) {
+    epsilon_ = epsilon;
+    return this;
+  }
+  springAnimator<T>* setMaxStep(float maxStep) {
+    maxStep_ = maxStep;
+    return this;
+  }
+  springAnimator<T>* setSpring(uint32_t handle, float stiffness, float damping, float mass) {
+    if (!valid(handle)) 
+      return this;
+    size_t i = slots_[handle];
+    stiffness_[i] = stiffness;
+    damping_[i]   = damping;
+    invMass_[i]   = 1.0f / mass;
+    return this;
+  }
+  
+  // ------ Queries -----------------------------------------------------------
+  bool isAnimating() {
+    return awake_ > 0;
+  }
+  bool isSleeping(uint32_t handle) {
+    return !valid(handle) || slots_[handle] >= awake_;
+  }
+  bool valid(uint32_t handle) const {
+    return handle < slots_.size() && slots_[handle] != uint32_t(Free);
+  }
+  size_t size() {
+    return pos_.size();
+  }
+  size_t activeCount() {
+    return awake_;
+  }
+  const T& velocity(uint32_t handle) {
+    return vel_[slots_[handle]];
+  }
+  
+  // ------ Snapshot support, targets go through the resolver -----------------
+  bool save(SnapshotWriter& out, SnapshotResolver& resolver) {
+    out.write(uint32_t(pos_.size()));
+    out.write(uint32_t(awake_));
+    out.write(uint32_t(slots_.size()));
+    out.write(epsilon_);
+    out.write(last_);
+    out.write(hasLast_);
+    out.write(maxStep_);
+    
+    for (size_t i = 0; i < pos_.size(); i++) {
+      out.write(resolver.targetId(var_[i]));
+      out.write(pos_[i]);
+      out.write(vel_[i]);
+      out.write(target_[i]);
+      out.write(stiffness_[i]);
+      out.write(damping_[i]);
+      out.write(invMass_[i]);
+      out.write(handles_[i]);
+    }
+    for (size_t i = 0; i < free_.size(); i++) {
+      out.write(free_[i]);
+    }
+    return true;
+  }
+  
+  bool restore(SnapshotReader& in, SnapshotResolver& resolver) {
+    uint32_t count = 0, awake = 0, handles = 0;
+    in.read(count);
+    in.read(awake);
+    in.read(handles);
+    in.read(epsilon_);
+    in.read(last_);
+    in.read(hasLast_);
+    in.read(maxStep_);
+    if (!in.ok() || awake > count || count > handles) 
+      return false;
+    
+    // Handles must survive as they were, an unknown target fails the restore
+    springAnimator<T> restored;
+    restored.slots_.assign(handles, uint32_t(Free));
+    for (uint32_t i = 0; i < count; i++) {
+      uint64_t id = 0;
+      T pos, vel, target;
+      float k = 0, c = 0, im = 0;
+      uint32_t handle = 0;
+      in.read(id); in.read(pos); in.read(vel); in.read(target);
+      in.read(k);  in.read(c);   in.read(im);  in.read(handle);
+      
+      T* var = static_cast<T*>(resolver.target(id));
+      if (!in.ok() || !var || handle >= handles || restored.valid(handle)) 
+        return false;
+      restored.var_.push_back(var);
+      restored.pos_.push_back(pos);
+      restored.vel_.push_back(vel);
+      restored.target_.push_back(target);
+      restored.stiffness_.push_back(k);
+      restored.damping_.push_back(c);
+      restored.invMass_.push_back(im);
+      restored.handles_.push_back(handle);
+      restored.slots_[handle] = i;
+    }
+    for (uint32_t i = count; i < handles; i++) {
+      uint32_t handle = 0;
+      in.read(handle);
+      restored.free_.push_back(handle);
+    }
+    if (!in.ok()) 
+      return false;
+    
+    var_.swap(restored.var_);           pos_.swap(restored.pos_);
+    vel_.swap(restored.vel_);           target_.swap(restored.target_);
+    stiffness_.swap(restored.stiffness_); damping_.swap(restored.damping_);
+    invMass_.swap(restored.invMass_);   handles_.swap(restored.handles_);
+    slots_.swap(restored.slots_);       free_.swap(restored.free_);
+    awake_ = awake;
+    return true;
+  }
+  void shift(const double offset) {
+    last_ += offset;
+  }
+  
+  // ------ Updater -----------------------------------------------------------
+  void update(const double ttime) {
+    float dt = hasLast_ ? float(ttime - last_) : 0;
+    last_ = ttime;
+    hasLast_ = true;
+    if (dt <= 0 || awake_ == 0) 
+      return;
+    if (dt > 0.25f) // don't explode after a long stall
+      dt = 0.25f;
+    
+    int steps = int(dt / maxStep_) + 1;
+    float h = dt / steps;
+    for (int s = 0; s < steps; s++) {
+      integrate(h);
+    }
+    
+    // ------ Write out, put settled springs to sleep -------------------------
+    for (size_t i = 0; i < awake_; ) {
+      if (ValueTraits<T>::length(target_[i] - pos_[i]) < epsilon_ &&
+          ValueTraits<T>::length(vel_[i]) < epsilon_) 
+      {
+        pos_[i] = target_[i];
+        vel_[i] = vel_[i] - vel_[i];
+        *var_[i] = pos_[i];
+        swap(i, --awake_);
+      } else {
+        *var_[i] = pos_[i];
+        ++i;
+      }
+    }
+  }
+  
+ protected:
+  // ------ Semi-implicit Euler over every awake spring -----------------------
+  void integrate(const float h) {
+    T*           pos  = &pos_[0];
+    T*           vel  = &vel_[0];
+    const T*     tgt  = &target_[0];
+    const float* k    = &stiffness_[0];
+    const float* c    = &damping_[0];
+    const float* im   = &invMass_[0];
+    const size_t n    = awake_;
+    
+    for (size_t i = 0; i < n; i++) {
+      T accel = ((tgt[i] - pos[i]) * k[i] - vel[i] * c[i]) * im[i];
+      vel[i] = vel[i] + accel * h;
+      pos[i] = pos[i] + vel[i] * h;
+    }
+  }
+  
+  void swap(size_t a, size_t b) {
+    if (a == b) return;
+    std::swap(var_[a], var_[b]);
+    std::swap(pos_[a], pos_[b]);
+    std::swap(vel_[a], vel_[b]);
+    std::swap(target_[a], target_[b]);
+    std::swap(stiffness_[a], stiffness_[b]);
+    std::swap(damping_[a], damping_[b]);
+    std::swap(invMass_[a], invMass_[b]);
+    std::swap(handles_[a], handles_[b]);
+    slots_[handles_[a]] = uint32_t(a);
+    slots_[handles_[b]] = uint32_t(b);
+  }
+  
+ protected:
+  size_t                awake_;
+  float                 epsilon_;
+  double                last_;
+  bool                  hasLast_;
+  float                 maxStep_;
+  
+  // ------ Spring state, one entry per slot ----------------------------------
+  std::vector<T*>       var_;
+  std::vector<T>        pos_;
+  std::vector<T>        vel_;
+  std::vector<T>        target_;
+  std::vector<float>    stiffness_;
+  std::vector<float>    damping_;
+  std::vector<float>    invMass_;
+  std::vector<uint32_t> handles_;
+  
+  // ------ Handle bookkeeping ------------------------------------------------
+  std::vector<uint32_t> slots_;
+  std::vector<uint32_t> free_;
+};
+
+} // namespace rp
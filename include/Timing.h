@@ -32,20 +32,55 @@
 
 #pragma once
 
+#include <stdint.h>
 #include <cmath>
 
+#include "Pool.h"
+#include "Snapshot.h"
+
 namespace rp {
+
+struct TimingKind
+{
+  enum Type {
+    Linear,   // play once
+    Repeat,   // 0..1, 0..1, ... ends on 1
+    PingPong, // 0..1..0, 0..1..0, ... ends on 0
+    Count
+  };
+};
   
-class TimeBase
+class TimeBase : public Pooled
 {
  public:
   TimeBase () {}
+  virtual ~TimeBase () {}
   virtual double operator()(double ttime, double start, double end, bool& finished) = 0;
+  
+  // ------ span(): durations until finished, HUGE_VAL for never -------------
+  virtual double span() { return 1; }
+  
+  // ------ progress(): operator() without touching any counters -------------
+  // What sampling uses, unknown timers sample like Timing::Linear
+  virtual double progress(double ttime, double start, double end, bool& finished) const {
+    double nT = (ttime - start) / end;
+    if (nT >= 1.0) {
+      finished = true;
+      return 1.0;
+    }
+    return nT;
+  }
+  
+  // ------ Snapshot support, unknown kinds restore as Timing::Linear ---------
+  virtual uint8_t kind() { return TimingKind::Count; }
+  virtual void save(SnapshotWriter& out) {}
+  virtual void restore(SnapshotReader& in) {}
 };
 
 /*
 // ====== Time Function Objects ===============================================
-These get passed into the go() method of the Animator class
+These get passed into the go() method of the Animator class, the animation
+takes ownership so hand each one its own
 
 Use:
   Time::Linear()     // base
@@ -70,12 +105,13 @@ struct Timing
       } 
       return nT;
     }
+    uint8_t kind() { return TimingKind::Linear; }
   };
   
   class Repeat : public TimeBase
   {
    public:
-    Repeat () : repeatForever_(true), repeatCt_(0) {}
+    Repeat () : repeatForever_(true), repeats_(0), repeatCt_(0) {}
     Repeat (int repeats) : 
       repeatForever_(false), 
       repeats_(repeats),
@@ -94,6 +130,29 @@ struct Timing
       }
       return s;
     }
+    
+    double progress(double ttime, double start, double end, bool& finished) const {
+      double nT = (ttime - start) / end;
+      if (!repeatForever_ && nT >= repeats_) {
+        finished = true;
+        return 1.0;
+      }
+      return nT - std::floor(nT);
+    }
+    
+    double span() { return repeatForever_ ? HUGE_VAL : repeats_; }
+    uint8_t kind() { return TimingKind::Repeat; }
+    void save(SnapshotWriter& out) {
+      out.write(repeatForever_);
+      out.write(repeats_);
+      out.write(repeatCt_);
+    }
+    void restore(SnapshotReader& in) {
+      in.read(repeatForever_);
+      in.read(repeats_);
+      in.read(repeatCt_);
+    }
+    
    private:
     bool repeatForever_;
     double repeats_;
@@ -103,7 +162,7 @@ struct Timing
   class PingPong : public TimeBase
   {
   public:
-    PingPong () : repeatForever_(true) {}
+    PingPong () : repeatForever_(true), repeats_(0), repeatCt_(0) {}
     PingPong (int repeats) : 
       repeatForever_(false),
       repeats_(repeats),
@@ -125,6 +184,29 @@ struct Timing
      return mnT;
     }
     
+    double progress(double ttime, double start, double end, bool& finished) const {
+      double nT = (ttime - start) / end;
+      if (!repeatForever_ && nT >= 2 * repeats_) {
+        finished = true;
+        return 0.0;
+      }
+      double mnT = fmod(nT, 1);
+      return (fmod(nT, 2) >= 1) ? 1 - mnT : mnT;
+    }
+    
+    double span() { return repeatForever_ ? HUGE_VAL : 2 * repeats_; }
+    uint8_t kind() { return TimingKind::PingPong; }
+    void save(SnapshotWriter& out) {
+      out.write(repeatForever_);
+      out.write(repeats_);
+      out.write(repeatCt_);
+    }
+    void restore(SnapshotReader& in) {
+      in.read(repeatForever_);
+      in.read(repeats_);
+      in.read(repeatCt_);
+    }
+    
   private:
     bool repeatForever_;
     double repeats_;
@@ -133,6 +215,15 @@ struct Timing
     bool ping_;
     bool pong_;
   };
+  
+  // ------ create(): empty timer for a TimingKind, used by restores ----------
+  static TimeBase* create(uint8_t kind) {
+    switch (kind) {
+      case TimingKind::Repeat:   return new Repeat();
+      case TimingKind::PingPong: return new PingPong();
+      default:                   return new Linear();
+    }
+  }
 };
 
 } // namespace rp
\ No newline at end of file
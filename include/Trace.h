@@ -0,0 +1,176 @@
+//  ------------------------------------------------------------------------ // 
+//  ===== Trace.h ========================================================== // 
+//  ------------------------------------------------------------------------ // 
+//   Created:        Kevin Webster                                           // 
+//   Date:           26.10.19                                                // 
+//   Copyright (c)   2010 All rights reserved.                               // 
+//  ------------------------------------------------------------------------ // 
+//  Redistribution and use in source and binary forms, with or without       // 
+//  modification, are permitted provided that the following conditions       // 
+//  are met:                                                                 // 
+//                                                                           // 
+//     * Redistributions of source code must retain the above copyright      // 
+//       notice, this list of conditions and the following disclaimer.       // 
+//     * Redistributions in binary form must reproduce the above copyright   // 
+//       notice, this list of conditions and the following disclaimer in     // 
+//       the documentation and/or other materials provided with the          // 
+//       distribution.                                                       // 
+//     * Stealing is also kinda lame.                                        // 
+//                                                                           // 
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS      // 
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT        // 
+//  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR    // 
+//  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT     // 
+//  HOLDER OR CONTRIBUTORS BE LIABLEFOR ANY DIRECT, INDIRECT, INCIDENTAL,    // 
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED // 
+//  TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR   // 
+//  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF   // 
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING     // 
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS       // 
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.             // 
+//  ------------------------------------------------------------------------ // 
+
+#pragma once
+
+/*
+// ====== Trace Events ========================================================
+Scoped timing around the phases of Ani::update(), compiled in with
+ANI_TRACE (needs C++11), compiled out to nothing otherwise.
+
+Each thread records into its own buffer, write() merges them into a Chrome
+trace-event JSON file for chrome://tracing or Perfetto:
+
+  ani.update(t);
+  ...
+  rp::Trace::write("ani_trace.json");
+
+Phases:
+  Ani::update        the whole pass
+  Ani::dispatch      draining deferred events
+  Animator::update   one animator, "id" is its address
+  easing             time & easing methods of one animation step
+  callback           one start/step/finish callback
+  cleanup            deleting a completed animation
+
+write() and clear() expect the recording threads to be quiet.
+
+*/
+
+#ifdef ANI_TRACE
+
+#include <stdint.h>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+namespace rp {
+
+struct TraceEvent
+{
+  const char* name;
+  uintptr_t   id;
+  int64_t     begin; // ns
+  int64_t     end;
+};
+
+struct TraceBuffer
+{
+  std::vector<TraceEvent> events;
+  unsigned                tid;
+};
+
+class Trace
+{
+ public:
+  static int64_t now() {
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+  }
+  
+  static void record(const char* name, uintptr_t id, int64_t begin, int64_t end) {
+    TraceEvent e = { name, id, begin, end };
+    local()->events.push_back(e);
+  }
+  
+  // ------ write(): flush every thread's events to a trace-event file -------
+  static bool write(const char* path) {
+    std::lock_guard<std::mutex> guard(lock());
+    FILE* f = std::fopen(path, "w");
+    if (!f) 
+      return false;
+    
+    std::fprintf(f, "{\"traceEvents\":[\n");
+    bool first = true;
+    for (size_t b = 0; b < buffers().size(); b++) {
+      const TraceBuffer* buf = buffers()[b];
+      for (size_t i = 0; i < buf->events.size(); i++) {
+        const TraceEvent& e = buf->events[i];
+        std::fprintf(f, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,"
+                        "\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"id\":\"%#lx\"}}",
+                     first ? "" : ",\n", e.name, buf->tid, 
+                     e.begin / 1000.0, (e.end - e.begin) / 1000.0, 
+                     (unsigned long)e.id);
+        first = false;
+      }
+    }
+    std::fprintf(f, "\n]}\n");
+    return std::fclose(f) == 0;
+  }
+  
+  static void clear() {
+    std::lock_guard<std::mutex> guard(lock());
+    for (size_t b = 0; b < buffers().size(); b++) {
+      buffers()[b]->events.clear();
+    }
+  }
+  
+ private:
+  static TraceBuffer* local() {
+    static thread_local TraceBuffer* buf = 0;
+    if (!buf) {
+      std::lock_guard<std::mutex> guard(lock());
+      buf = new TraceBuffer();
+      buf->events.reserve(1 << 16);
+      buf->tid = unsigned(buffers().size()) + 1;
+      buffers().push_back(buf); // lives as long as the process
+    }
+    return buf;
+  }
+  static std::mutex& lock() {
+    static std::mutex m;
+    return m;
+  }
+  static std::vector<TraceBuffer*>& buffers() {
+    static std::vector<TraceBuffer*> all;
+    return all;
+  }
+};
+
+class TraceScope
+{
+ public:
+  TraceScope (const char* name, const void* id) 
+        : name_(name), id_(reinterpret_cast<uintptr_t>(id)), begin_(Trace::now()) {}
+  ~TraceScope () { 
+    Trace::record(name_, id_, begin_, Trace::now()); 
+  }
+  
+ private:
+  const char* name_;
+  uintptr_t   id_;
+  int64_t     begin_;
+};
+
+} // namespace rp
+
+#define ANI_TRACE_JOIN2(a, b) a##b
+#define ANI_TRACE_JOIN(a, b) ANI_TRACE_JOIN2(a, b)
+#define ANI_TRACE_SCOPE(name, id) \
+  rp::TraceScope ANI_TRACE_JOIN(aniTraceScope, __LINE__)(name, id)
+
+#else
+
+#define ANI_TRACE_SCOPE(name, id)
+
+#endif
@@ -0,0 +1,129 @@
+//  ------------------------------------------------------------------------ // 
+//  ===== Value.h ========================================================== // 
+//  ------------------------------------------------------------------------ // 
+//   Created:        Kevin Webster                                           // 
+//   Date:           26.10.19                                                // 
+//   Copyright (c)   2010 All rights reserved.                               // 
+//  ------------------------------------------------------------------------ // 
+//  Redistribution and use in source and binary forms, with or without       // 
+//  modification, are permitted provided that the following conditions       // 
+//  are met:                                                                 // 
+//                                                                           // 
+//     * Redistributions of source code must retain the above copyright      // 
+//       notice, this list of conditions and the following disclaimer.       // 
+//     * Redistributions in binary form must reproduce the above copyright   // 
+//       notice, this list of conditions and the following disclaimer in     // 
+//       the documentation and/or other materials provided with the          // 
+//       distribution.                                                       // 
+//     * Stealing is also kinda lame.                                        // 
+//                                                                           // 
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS      // 
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT        // 
+//  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR    // 
+//  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT     // 
+//  HOLDER OR CONTRIBUTORS BE LIABLEFOR ANY DIRECT, INDIRECT, INCIDENTAL,    // 
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED // 
+//  TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR   // 
+//  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF   // 
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING     // 
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS       // 
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.             // 
+//  ------------------------------------------------------------------------ // 
+
+#pragma once
+
+#include <cmath>
+
+namespace rp {
+
+/*
+// ====== Value Traits ========================================================
+Animations only need +, - and * from a value type. A few features need to
+know how big a value is as well (path lengths, settling checks), which is
+what ValueTraits is for.
+
+The default expects a length() member like Cinder's Vec2f/Vec3f have, 
+specialize it for anything else:
+
+  template <> struct ValueTraits<MyType> { 
+    static double length(const MyType& v) { return v.magnitude(); } 
+  };
+
+*/
+
+template <typename T>
+struct ValueTraits
+{
+  static double length(const T& v) { return v.length(); }
+};
+
+template <> struct ValueTraits<float>
+{
+  static double length(const float& v) { return std::fabs(v); }
+};
+
+template <> struct ValueTraits<double>
+{
+  static double length(const double& v) { return std::fabs(v); }
+};
+
+template <> struct ValueTraits<int>
+{
+  static double length(const int& v) { return std::fabs(double(v)); }
+};
+
+/*
+// ====== Ease Traits =========================================================
+Animations ease a value as beginning + change * curve. EaseTraits picks the
+change for a new animation and gets a look at every eased value, by default
+that's final - beginning and nothing. Rotations use it to take the short 
+way round and stay unit length, see Quat in Vector.h.
+
+*/
+
+template <typename T>
+struct EaseTraits
+{
+  static T change(const T& beginning, const T& finalVal) { return finalVal - beginning; }
+  static void normalize(T& v) {}
+};
+
+/*
+  ValueSettle<T>::within(a, b, epsilon): whether two values are closer than
+  epsilon, for settling animations early. Works out of the box for types 
+  with a length() member and the ones ValueTraits is specialized for here,
+  anything else never counts as close. Specialize HasLength to opt in a
+  type with its own ValueTraits.
+*/
+template <typename T>
+struct HasLength
+{
+  template <typename U> 
+  static char test(U*, char (*)[sizeof(&U::length)] = 0);
+  static long test(...);
+  enum { value = sizeof(test(static_cast<T*>(0))) == 1 };
+};
+template <> struct HasLength<float>  { enum { value = 1 }; };
+template <> struct HasLength<double> { enum { value = 1 }; };
+template <> struct HasLength<int>    { enum { value = 1 }; };
+
+template <typename T, bool = HasLength<T>::value>
+struct ValueSettle
+{
+  static bool within(const T& a, const T& b, double epsilon) { return false; }
+};
+template <typename T>
+struct ValueSettle<T, true>
+{
+  static bool within(const T& a, const T& b, double epsilon) {
+    return ValueTraits<T>::length(b - a) < epsilon;
+  }
+};
+
+// ------ valueDistance(): length of the difference between two values ------
+template <typename T>
+double valueDistance(const T& a, const T& b) {
+  return ValueTraits<T>::length(b - a);
+}
+
+} // namespace rp
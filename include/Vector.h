@@ -0,0 +1,376 @@
+//  ------------------------------------------------------------------------ // 
+//  ===== Vector.h ========================================================= // 
+//  ------------------------------------------------------------------------ // 
+//   Created:        Kevin Webster                                           // 
+//   Date:           26.10.19                                                // 
+//   Copyright (c)   2010 All rights reserved.                               // 
+//  ------------------------------------------------------------------------ // 
+//  Redistribution and use in source and binary forms, with or without       // 
+//  modification, are permitted provided that the following conditions       // 
+//  are met:                                                                 // 
+//                                                                           // 
+//     * Redistributions of source code must retain the above copyright      // 
+//       notice, this list of conditions and the following disclaimer.       // 
+//     * Redistributions in binary form must reproduce the above copyright   // 
+//       notice, this list of conditions and the following disclaimer in     // 
+//       the documentation and/or other materials provided with the          // 
+//       distribution.                                                       // 
+//     * Stealing is also kinda lame.                                        // 
+//                                                                           // 
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS      // 
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT        // 
+//  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR    // 
+//  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT     // 
+//  HOLDER OR CONTRIBUTORS BE LIABLEFOR ANY DIRECT, INDIRECT, INCIDENTAL,    // 
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED // 
+//  TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR   // 
+//  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF   // 
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING     // 
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS       // 
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.             // 
+//  ------------------------------------------------------------------------ // 
+
+#pragma once
+
+#include <cmath>
+#include <stddef.h>
+
+#include "Value.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ANI_HAS_SSE2 1
+#endif
+
+#if __cplusplus >= 201103L
+#define ANI_ALIGN(n) alignas(n)
+#elif defined(_MSC_VER)
+#define ANI_ALIGN(n) __declspec(align(n))
+#else
+#define ANI_ALIGN(n) __attribute__((aligned(n)))
+#endif
+
+namespace rp {
+
+/*
+// ====== Vector Values =======================================================
+Float vectors and a quaternion that work with every Ease curve out of the 
+box, for when there's no Cinder around. Vec3 is padded to 16 bytes so all
+of them but Vec2 fill exactly one SSE register.
+
+Quaternions ease as normalized lerp: EaseTraits<Quat> takes the change
+towards the nearer of q and -q, and renormalizes every eased value. The
+curve still shapes the progress, so OutBack overshoots the rotation.
+
+For many animations at once VectorBatch takes eased progress values, e.g.
+straight from EaseFast::batch():
+
+  EaseFast::batch<EaseFast::outExpo>(progress, eased, n);
+  VectorBatch::slerp(from, to, eased, rotations, n);
+
+*/
+struct ANI_ALIGN(8) Vec2
+{
+  Vec2 () : x(0), y(0) {}
+  Vec2 (float x_, float y_) : x(x_), y(y_) {}
+  
+  Vec2 operator+(const Vec2& v) const { return Vec2(x + v.x, y + v.y); }
+  Vec2 operator-(const Vec2& v) const { return Vec2(x - v.x, y - v.y); }
+  Vec2 operator-() const { return Vec2(-x, -y); }
+  Vec2 operator*(double s) const { return Vec2(float(x * s), float(y * s)); }
+  Vec2 operator/(double s) const { return *this * (1.0 / s); }
+  
+  float dot(const Vec2& v) const { return x * v.x + y * v.y; }
+  float length() const { return std::sqrt(dot(*this)); }
+  
+  float x, y;
+};
+
+struct ANI_ALIGN(16) Vec3
+{
+  Vec3 () : x(0), y(0), z(0), pad(0) {}
+  Vec3 (float x_, float y_, float z_) : x(x_), y(y_), z(z_), pad(0) {}
+  
+  Vec3 operator+(const Vec3& v) const { return Vec3(x + v.x, y + v.y, z + v.z); }
+  Vec3 operator-(const Vec3& v) const { return Vec3(x - v.x, y - v.y, z - v.z); }
+  Vec3 operator-() const { return Vec3(-x, -y, -z); }
+  Vec3 operator*(double s) const { 
+    return Vec3(float(x * s), float(y * s), float(z * s)); 
+  }
+  Vec3 operator/(double s) const { return *this * (1.0 / s); }
+  
+  float dot(const Vec3& v) const { return x * v.x + y * v.y + z * v.z; }
+  float length() const { return std::sqrt(dot(*this)); }
+  
+  float x, y, z;
+  float pad; // keeps it one register wide, always 0
+};
+
+struct ANI_ALIGN(16) Vec4
+{
+  Vec4 () : x(0), y(0), z(0), w(0) {}
+  Vec4 (float x_, float y_, float z_, float w_) : x(x_), y(y_), z(z_), w(w_) {}
+  
+  Vec4 operator+(const Vec4& v) const { return Vec4(x + v.x, y + v.y, z + v.z, w + v.w); }
+  Vec4 operator-(const Vec4& v) const { return Vec4(x - v.x, y - v.y, z - v.z, w - v.w); }
+  Vec4 operator-() const { return Vec4(-x, -y, -z, -w); }
+  Vec4 operator*(double s) const { 
+    return Vec4(float(x * s), float(y * s), float(z * s), float(w * s)); 
+  }
+  Vec4 operator/(double s) const { return *this * (1.0 / s); }
+  
+  float dot(const Vec4& v) const { return x * v.x + y * v.y + z * v.z + w * v.w; }
+  float length() const { return std::sqrt(dot(*this)); }
+  
+  float x, y, z, w;
+};
+
+/*=============================================================================
+          Quat: unit quaternion, w last
+=============================================================================*/
+struct ANI_ALIGN(16) Quat
+{
+  Quat () : x(0), y(0), z(0), w(1) {}
+  Quat (float x_, float y_, float z_, float w_) : x(x_), y(y_), z(z_), w(w_) {}
+  
+  // ------ axisAngle(): rotation by angle radians around a unit axis ---------
+  static Quat axisAngle(const Vec3& axis, double angle) {
+    const float s = float(std::sin(angle * .5));
+    return Quat(axis.x * s, axis.y * s, axis.z * s, float(std::cos(angle * .5)));
+  }
+  
+  // Component-wise, which is what easing b + c * curve needs
+  Quat operator+(const Quat& q) const { return Quat(x + q.x, y + q.y, z + q.z, w + q.w); }
+  Quat operator-(const Quat& q) const { return Quat(x - q.x, y - q.y, z - q.z, w - q.w); }
+  Quat operator-() const { return Quat(-x, -y, -z, -w); }
+  Quat operator*(double s) const { 
+    return Quat(float(x * s), float(y * s), float(z * s), float(w * s)); 
+  }
+  Quat operator/(double s) const { return *this * (1.0 / s); }
+  
+  float dot(const Quat& q) const { return x * q.x + y * q.y + z * q.z + w * q.w; }
+  float length() const { return std::sqrt(dot(*this)); }
+  Quat normalized() const {
+    const float len = length();
+    return len > 0 ? *this * (1.0 / len) : Quat();
+  }
+  
+  // ------ nlerp() & slerp(): the shorter way from a to b --------------------
+  static Quat nlerp(const Quat& a, const Quat& b, float t) {
+    const Quat to = a.dot(b) < 0 ? -b : b;
+    return (a + (to - a) * t).normalized();
+  }
+  static Quat slerp(const Quat& a, const Quat& b, float t) {
+    float d = a.dot(b);
+    const Quat to = d < 0 ? -b : b;
+    d = std::fabs(d);
+    if (d > 0.9995f) // sin(theta) runs out of precision, nlerp is as good
+      return (a + (to - a) * t).normalized();
+    const float theta = std::acos(d);
+    const float s = 1.0f / std::sin(theta);
+    return a * (std::sin((1 - t) * theta) * s) + to * (std::sin(t * theta) * s);
+  }
+  
+  float x, y, z, w;
+};
+
+// ------ Quaternions ease the short way round and stay unit length -----------
+template <> struct EaseTraits<Quat>
+{
+  static Quat change(const Quat& beginning, const Quat& finalVal) {
+    return (beginning.dot(finalVal) < 0 ? -finalVal : finalVal) - beginning;
+  }
+  static void normalize(Quat& v) { v = v.normalized(); }
+};
+
+
+/*=============================================================================
+          VectorBatch: many animations per instruction
+===============================================================================
+
+  Every function takes a progress value per element, already eased. lerp()
+  works on beginning & change like the Ease curves do, out = b + c * t. It
+  does one Vec3/Vec4 or two Vec2 per instruction. 
+  
+  nlerp() and slerp() go from one rotation to another. They transpose four
+  quaternions into x, y, z and w registers and interpolate all four at once.
+  slerp() gets its angles from float fits of acos and sin instead of libm,
+  within 1e-6 of Quat::slerp().
+  
+  Arrays don't need to be aligned, in and out may be the same array.
+
+*/
+struct VectorBatch
+{
+  static void lerp(const Vec2* b, const Vec2* c, const float* t, Vec2* out, size_t n) {
+    size_t i = 0;
+#ifdef ANI_HAS_SSE2
+    for (; i + 2 <= n; i += 2) {
+      const __m128 vt = _mm_set_ps(t[i + 1], t[i + 1], t[i], t[i]);
+      const __m128 r = _mm_add_ps(_mm_loadu_ps(&b[i].x), 
+                                  _mm_mul_ps(_mm_loadu_ps(&c[i].x), vt));
+      _mm_storeu_ps(&out[i].x, r);
+    }
+#endif
+    for (; i < n; i++) {
+      out[i] = Vec2(b[i].x + c[i].x * t[i], b[i].y + c[i].y * t[i]);
+    }
+  }
+  
+  static void lerp(const Vec3* b, const Vec3* c, const float* t, Vec3* out, size_t n) {
+    // Same layout, the padding stays 0 + 0 * t
+    lerp4(&b->x, &c->x, t, &out->x, n);
+  }
+  static void lerp(const Vec4* b, const Vec4* c, const float* t, Vec4* out, size_t n) {
+    lerp4(&b->x, &c->x, t, &out->x, n);
+  }
+  
+  static void nlerp(const Quat* from, const Quat* to, const float* t, Quat* out, size_t n) {
+    size_t i = 0;
+#ifdef ANI_HAS_SSE2
+    for (; i + 4 <= n; i += 4) {
+      Lanes a, b;
+      load(from + i, a);
+      load(to + i, b);
+      shorter(a, b);
+      blend(a, _mm_sub_ps(_mm_set1_ps(1.0f), _mm_loadu_ps(t + i)), 
+            b, _mm_loadu_ps(t + i));
+      normalize(a);
+      store(a, out + i);
+    }
+#endif
+    for (; i < n; i++) {
+      out[i] = Quat::nlerp(from[i], to[i], t[i]);
+    }
+  }
+  
+  static void slerp(const Quat* from, const Quat* to, const float* t, Quat* out, size_t n) {
+    size_t i = 0;
+#ifdef ANI_HAS_SSE2
+    const __m128 one = _mm_set1_ps(1.0f);
+    for (; i + 4 <= n; i += 4) {
+      Lanes a, b;
+      load(from + i, a);
+      load(to + i, b);
+      const __m128 d  = shorter(a, b);
+      const __m128 vt = _mm_loadu_ps(t + i);
+      
+      // Angles in quarter turns, sin(theta) = sine(u)
+      const __m128 u  = _mm_mul_ps(acos(d), _mm_set1_ps(0.6366197724f));
+      const __m128 s  = _mm_div_ps(one, sine(u));
+      __m128 wa = _mm_mul_ps(sine(_mm_mul_ps(_mm_sub_ps(one, vt), u)), s);
+      __m128 wb = _mm_mul_ps(sine(_mm_mul_ps(vt, u)), s);
+      
+      // sin(theta) runs out of precision close together, nlerp there
+      const __m128 close = _mm_cmpgt_ps(d, _mm_set1_ps(0.9995f));
+      wa = select(close, _mm_sub_ps(one, vt), wa);
+      wb = select(close, vt, wb);
+      
+      blend(a, wa, b, wb);
+      normalize(a); // only changes the nlerp lanes
+      store(a, out + i);
+    }
+#endif
+    for (; i < n; i++) {
+      out[i] = Quat::slerp(from[i], to[i], t[i]);
+    }
+  }
+  
+ private:
+  static void lerp4(const float* b, const float* c, const float* t, float* out, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+#ifdef ANI_HAS_SSE2
+      const __m128 r = _mm_add_ps(_mm_loadu_ps(b + 4 * i), 
+                                  _mm_mul_ps(_mm_loadu_ps(c + 4 * i), _mm_set1_ps(t[i])));
+      _mm_storeu_ps(out + 4 * i, r);
+#else
+      for (int k = 0; k < 4; k++) {
+        out[4 * i + k] = b[4 * i + k] + c[4 * i + k] * t[i];
+      }
+#endif
+    }
+  }
+  
+#ifdef ANI_HAS_SSE2
+  // Four quaternions, one component per register
+  struct Lanes { __m128 x, y, z, w; };
+  
+  static void load(const Quat* q, Lanes& l) {
+    l.x = _mm_loadu_ps(&q[0].x);
+    l.y = _mm_loadu_ps(&q[1].x);
+    l.z = _mm_loadu_ps(&q[2].x);
+    l.w = _mm_loadu_ps(&q[3].x);
+    _MM_TRANSPOSE4_PS(l.x, l.y, l.z, l.w);
+  }
+  static void store(Lanes l, Quat* q) {
+    _MM_TRANSPOSE4_PS(l.x, l.y, l.z, l.w);
+    _mm_storeu_ps(&q[0].x, l.x);
+    _mm_storeu_ps(&q[1].x, l.y);
+    _mm_storeu_ps(&q[2].x, l.z);
+    _mm_storeu_ps(&q[3].x, l.w);
+  }
+  static __m128 dot(const Lanes& a, const Lanes& b) {
+    return _mm_add_ps(_mm_add_ps(_mm_mul_ps(a.x, b.x), _mm_mul_ps(a.y, b.y)),
+                      _mm_add_ps(_mm_mul_ps(a.z, b.z), _mm_mul_ps(a.w, b.w)));
+  }
+  
+  // ------ shorter(): flips b where -b is closer to a, returns |a.b| ---------
+  static __m128 shorter(const Lanes& a, Lanes& b) {
+    const __m128 d = dot(a, b);
+    const __m128 sign = _mm_and_ps(d, _mm_set1_ps(-0.0f));
+    b.x = _mm_xor_ps(b.x, sign);
+    b.y = _mm_xor_ps(b.y, sign);
+    b.z = _mm_xor_ps(b.z, sign);
+    b.w = _mm_xor_ps(b.w, sign);
+    return _mm_xor_ps(d, sign);
+  }
+  
+  // a = a * wa + b * wb
+  static void blend(Lanes& a, __m128 wa, const Lanes& b, __m128 wb) {
+    a.x = _mm_add_ps(_mm_mul_ps(a.x, wa), _mm_mul_ps(b.x, wb));
+    a.y = _mm_add_ps(_mm_mul_ps(a.y, wa), _mm_mul_ps(b.y, wb));
+    a.z = _mm_add_ps(_mm_mul_ps(a.z, wa), _mm_mul_ps(b.z, wb));
+    a.w = _mm_add_ps(_mm_mul_ps(a.w, wa), _mm_mul_ps(b.w, wb));
+  }
+  
+  static __m128 select(__m128 mask, __m128 a, __m128 b) {
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+  }
+  
+  // ------ acos(): for x in [0, 1], sqrt(1 - x) times a degree 7 fit ---------
+  // Abramowitz & Stegun 4.4.46, within 2e-8 before float rounding
+  static __m128 acos(__m128 x) {
+    __m128 p = _mm_set1_ps(-0.0012624911f);
+    p = _mm_add_ps(_mm_mul_ps(p, x), _mm_set1_ps( 0.0066700901f));
+    p = _mm_add_ps(_mm_mul_ps(p, x), _mm_set1_ps(-0.0170881256f));
+    p = _mm_add_ps(_mm_mul_ps(p, x), _mm_set1_ps( 0.0308918810f));
+    p = _mm_add_ps(_mm_mul_ps(p, x), _mm_set1_ps(-0.0501743046f));
+    p = _mm_add_ps(_mm_mul_ps(p, x), _mm_set1_ps( 0.0889789874f));
+    p = _mm_add_ps(_mm_mul_ps(p, x), _mm_set1_ps(-0.2145988016f));
+    p = _mm_add_ps(_mm_mul_ps(p, x), _mm_set1_ps( 1.5707963050f));
+    const __m128 r = _mm_max_ps(_mm_sub_ps(_mm_set1_ps(1.0f), x), _mm_setzero_ps());
+    return _mm_mul_ps(_mm_sqrt_ps(r), p);
+  }
+  
+  // ------ sine(): sin(x * pi/2) for x in [0, 1], as EaseFast::sine() --------
+  static __m128 sine(__m128 x) {
+    const __m128 u = _mm_mul_ps(x, x);
+    __m128 q = _mm_set1_ps(-0.0001506268478f);
+    q = _mm_add_ps(_mm_mul_ps(q, u), _mm_set1_ps( 0.004521209826f));
+    q = _mm_add_ps(_mm_mul_ps(q, u), _mm_set1_ps(-0.07516701146f));
+    q = _mm_add_ps(_mm_mul_ps(q, u), _mm_set1_ps( 0.5707962861f));
+    const __m128 w = _mm_mul_ps(_mm_mul_ps(x, _mm_sub_ps(_mm_set1_ps(1.0f), u)), q);
+    return _mm_add_ps(x, w);
+  }
+  
+  static void normalize(Lanes& a) {
+    const __m128 inv = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(dot(a, a)));
+    a.x = _mm_mul_ps(a.x, inv);
+    a.y = _mm_mul_ps(a.y, inv);
+    a.z = _mm_mul_ps(a.z, inv);
+    a.w = _mm_mul_ps(a.w, inv);
+  }
+#endif
+};
+
+} // namespace rp
@@ -0,0 +1,451 @@
+#include "../include/Ani.h"
+#include "../include/EaseFast.h"
+#include "../include/Scheduler.h"
+#include "../include/Bake.h"
+#include <ctime>
+#include <cstdlib>
+
+using namespace std;
+using namespace rp;
+
+/*
+  Rough per evaluation costs, run with an optimized build:
+  
+    g++ -O2 tests/AniBench.cpp -o anibench && ./anibench
+*/
+
+static const int kEvals = 20000000;
+
+// ------ Time an easing method through a function pointer --------------------
+double benchEase(const char* name, float (*ease)(double t, float b, float c, double d)) {
+  volatile float sink = 0;
+  float acc = 0;
+  
+  clock_t begin = clock();
+  for (int i = 0; i < kEvals; i++) {
+    acc += ease(double(i & 1023) / 1023.0, 0.0f, 1.0f, 1.0);
+  }
+  clock_t end = clock();
+  sink = sink + acc;
+  
+  double ns = double(end - begin) / CLOCKS_PER_SEC * 1e9 / kEvals;
+  cout << name << ": " << ns << " ns/eval" << endl;
+  return ns;
+}
+
+// Progress arrays, the way a batched update pass hands them over
+static const int kBatch = 1024;
+
+template <float (*Curve)(float x)>
+double benchBatch(const char* name) {
+  vector<float> x(kBatch), out(kBatch);
+  for (int i = 0; i < kBatch; i++) {
+    x[i] = float(i) / (kBatch - 1);
+  }
+  
+  volatile float sink = 0;
+  clock_t begin = clock();
+  for (int n = 0; n < kEvals / kBatch; n++) {
+    EaseFast::batch<Curve>(&x[0], &out[0], kBatch);
+    sink = sink + out[n & (kBatch - 1)];
+  }
+  clock_t end = clock();
+  
+  double ns = double(end - begin) / CLOCKS_PER_SEC * 1e9 / kEvals;
+  cout << name << ": " << ns << " ns/eval" << endl;
+  return ns;
+}
+
+static const int kRecords = 10000;
+static const int kTicks   = 2000;
+
+// One curve & timing for every record vs the full mix, same count and phases.
+// Bucketing should keep the mix close to the single curve.
+double benchCompact(const char* name, bool mixed) {
+  vector<float> vars(kRecords, 0.0f);
+  compactAnimator<float> compact;
+  
+  srand(1);
+  for (int i = 0; i < kRecords; i++) {
+    EaseKind::Type ease = mixed ? EaseKind::Type(rand() % EaseKind::Count) 
+                                : EaseKind::InOutCubic;
+    TimingKind::Type timing = mixed ? TimingKind::Type(1 + rand() % 2) 
+                                    : TimingKind::Repeat;
+    compact.go(&vars[i], 0.75, 10, ease, timing, 0, (i % 45) / 60.0);
+  }
+  
+  clock_t begin = clock();
+  for (int t = 0; t < kTicks; t++) {
+    compact.update(t / 60.0);
+  }
+  clock_t end = clock();
+  
+  double ns = double(end - begin) / CLOCKS_PER_SEC * 1e9 / (double(kTicks) * kRecords);
+  cout << name << ": " << ns << " ns/record" << endl;
+  return ns;
+}
+
+// One update pass vs a 64 sample preview of the same animations
+static const int kSamples = 64;
+
+void benchSample() {
+  vector<float> vars(kRecords, 0.0f), cvars(kRecords, 0.0f);
+  vector<double> times(kSamples);
+  vector<float> out(size_t(kRecords) * kSamples);
+  for (int i = 0; i < kSamples; i++) {
+    times[i] = i / double(kSamples - 1);
+  }
+  
+  Ani ani;
+  vector<AnimationBase<float>*> anims(kRecords);
+  for (int i = 0; i < kRecords; i++) {
+    anims[i] = ani.mate(&vars[i])->go(1.0, 10, Ease::InOutCubic)->getCurrentAnimation();
+    ani.compact<float>()->go(&cvars[i], 1.0, 10, EaseKind::InOutCubic);
+  }
+  ani.update(0);
+  
+  const int kRuns = 20;
+  clock_t begin = clock();
+  for (int r = 0; r < kRuns; r++) {
+    ani.update(0.5);
+  }
+  clock_t mid = clock();
+  for (int r = 0; r < kRuns; r++) {
+    sampleAnimations(&anims[0], kRecords, &times[0], kSamples, &out[0], 0);
+  }
+  clock_t mid2 = clock();
+  for (int r = 0; r < kRuns; r++) {
+    ani.compact<float>()->sample(&times[0], kSamples, &out[0], 0);
+  }
+  clock_t end = clock();
+  
+  double ms = 1e3 / CLOCKS_PER_SEC / kRuns;
+  cout << "update() of " << kRecords << " + " << kRecords << " compact: " 
+       << double(mid - begin) * ms << " ms" << endl;
+  cout << kSamples << " samples of " << kRecords << " animations: " 
+       << double(mid2 - mid) * ms << " ms" << endl;
+  cout << kSamples << " samples of " << kRecords << " compact records: " 
+       << double(end - mid2) * ms << " ms" << endl;
+}
+
+// Setter called per object vs one bulk call per update
+class Entity
+{
+ public:
+  Entity () : x(0) {}
+  void setX(float v) { x = v; }
+  float x;
+};
+
+void setEntitiesX(Entity* const* objs, const float* values, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    objs[i]->x = values[i];
+  }
+}
+
+void benchSetter(const char* name, bool batched) {
+  vector<Entity> entities(kRecords);
+  Ani ani;
+  batchAnimator<Entity, float>* xs = ani.batch(&Entity::setX, setEntitiesX);
+  
+  for (int i = 0; i < kRecords; i++) {
+    if (batched) 
+      xs->go(&entities[i], 1e9, 0, 100);
+    else 
+      ani.mate(&entities[i], &Entity::setX)->anim(1e9, 0, 100)->go();
+  }
+  
+  const int kRuns = 200;
+  clock_t begin = clock();
+  for (int r = 0; r < kRuns; r++) {
+    ani.update(r);
+  }
+  clock_t end = clock();
+  
+  cout << name << ": " << double(end - begin) * 1e3 / CLOCKS_PER_SEC / kRuns 
+       << " ms per update of " << kRecords << endl;
+}
+
+// Starting and running the same style of tween, full animations vs instances
+void benchPrototype(const char* name, bool prototyped) {
+  vector<float> vars(kRecords, 0.0f);
+  Ani ani;
+  prototypeAnimator<float>* style = 
+    ani.prototype(AnimationStyle<float>(.5, Ease::OutCubic));
+  
+  const int kRounds = 20;
+  clock_t begin = clock();
+  for (int r = 0; r < kRounds; r++) {
+    for (int i = 0; i < kRecords; i++) {
+      if (prototyped) 
+        style->go(&vars[i], float(r));
+      else 
+        ani.mate(&vars[i])->go(.5, float(r), Ease::OutCubic);
+    }
+    for (int t = 0; t <= 10; t++) {
+      ani.update(r + t * .05);
+    }
+  }
+  clock_t end = clock();
+  
+  cout << name << ": " << double(end - begin) * 1e3 / CLOCKS_PER_SEC / kRounds 
+       << " ms per " << kRecords << " started & run for 11 updates" << endl;
+}
+
+// Scalar loops vs VectorBatch on eased progress
+void benchVectors() {
+  vector<Vec3> b(kRecords), c(kRecords, Vec3(1, 2, 3)), v(kRecords);
+  vector<Quat> from(kRecords), to(kRecords), q(kRecords);
+  vector<float> t(kRecords);
+  for (int i = 0; i < kRecords; i++) {
+    t[i] = float(i) / kRecords;
+    from[i] = Quat::axisAngle(Vec3(1, 0, 0), i * .001);
+    to[i] = Quat::axisAngle(Vec3(0, 1, 0), 1 + i * .001);
+  }
+  
+  const int kRuns = 200;
+  clock_t t0 = clock();
+  for (int r = 0; r < kRuns; r++) {
+    for (int i = 0; i < kRecords; i++) v[i] = b[i] + c[i] * t[i];
+  }
+  clock_t t1 = clock();
+  for (int r = 0; r < kRuns; r++) {
+    VectorBatch::lerp(&b[0], &c[0], &t[0], &v[0], kRecords);
+  }
+  clock_t t2 = clock();
+  for (int r = 0; r < kRuns; r++) {
+    for (int i = 0; i < kRecords; i++) q[i] = Quat::nlerp(from[i], to[i], t[i]);
+  }
+  clock_t t3 = clock();
+  for (int r = 0; r < kRuns; r++) {
+    VectorBatch::nlerp(&from[0], &to[0], &t[0], &q[0], kRecords);
+  }
+  clock_t t4 = clock();
+  for (int r = 0; r < kRuns; r++) {
+    for (int i = 0; i < kRecords; i++) q[i] = Quat::slerp(from[i], to[i], t[i]);
+  }
+  clock_t t5 = clock();
+  for (int r = 0; r < kRuns; r++) {
+    VectorBatch::slerp(&from[0], &to[0], &t[0], &q[0], kRecords);
+  }
+  clock_t t6 = clock();
+  
+  double us = 1e6 / CLOCKS_PER_SEC / kRuns;
+  cout << "Vec3 lerp, scalar: " << (t1 - t0) * us << " us, batch: " << (t2 - t1) * us << " us" << endl;
+  cout << "Quat nlerp, scalar: " << (t3 - t2) * us << " us, batch: " << (t4 - t3) * us << " us" << endl;
+  cout << "Quat slerp, scalar: " << (t5 - t4) * us << " us, batch: " << (t6 - t5) * us << " us" << endl;
+}
+
+// OutExpo alpha fades at 60 fps, run to the end vs settled at 8 bit steps
+void benchSettle(const char* name, double epsilon) {
+  vector<float> vars(kRecords, 0.0f);
+  Ani ani;
+  ani.setSettle(epsilon);
+  
+  const int kRounds = 20;
+  clock_t begin = clock();
+  for (int r = 0; r < kRounds; r++) {
+    for (int i = 0; i < kRecords; i++) {
+      ani.mate(&vars[i])->go(1.0, float(r % 2), Ease::OutExpo);
+    }
+    for (int t = 0; t <= 60; t++) {
+      ani.update(r * 2 + t / 60.0);
+    }
+  }
+  clock_t end = clock();
+  
+  cout << name << ": " << double(end - begin) * 1e3 / CLOCKS_PER_SEC / kRounds 
+       << " ms per " << kRecords << " animations over 61 updates" << endl;
+}
+
+// Ten seconds at 60 per second of a few chained curves per channel, fitted
+// at 1/1000 of their range, then replayed frame by frame
+void benchBake() {
+  const int kChannels = 1000, kFrames = 600;
+  float (*curves[])(double, float, float, double) = 
+    { Ease::InOutCubic, Ease::OutExpo, Ease::InOutSine, Ease::OutBounce };
+  vector<float> raw(kChannels * kFrames);
+  srand(7);
+  for (int c = 0; c < kChannels; c++) {
+    float from = 0;
+    for (int f = 0, piece = c; f < kFrames; piece++) {
+      int len = 30 + rand() % 120;
+      float to = float(rand() % 100);
+      for (int i = 0; i < len && f < kFrames; i++, f++) {
+        raw[c * kFrames + f] = curves[piece % 4](double(i) / len, from, to - from, 1);
+      }
+      from = to;
+    }
+  }
+  
+  clock_t begin = clock();
+  BakeWriter writer(60);
+  for (int c = 0; c < kChannels; c++) {
+    writer.add(&raw[c * kFrames], kFrames, .1f);
+  }
+  SnapshotWriter out;
+  writer.write(out);
+  clock_t mid = clock();
+  
+  BakedCurves baked;
+  baked.open(&out.data()[0], out.size());
+  vector<BakeStream> streams;
+  for (int c = 0; c < kChannels; c++) streams.push_back(BakeStream(baked, c));
+  volatile float sink = 0;
+  for (int f = 0; f < kFrames; f++) {
+    for (int c = 0; c < kChannels; c++) sink = sink + streams[c].at(f / 60.0);
+  }
+  clock_t end = clock();
+  
+  cout << "raw: " << raw.size() * sizeof(float) / 1024 << " KB, baked: " 
+       << out.size() / 1024 << " KB in " << writer.segments() << " segments" << endl;
+  cout << "fit: " << double(mid - begin) * 1e3 / CLOCKS_PER_SEC << " ms, replay: " 
+       << double(end - mid) * 1e9 / CLOCKS_PER_SEC / raw.size() << " ns per value" << endl;
+}
+
+// A million RGBA pixels faded per frame, eased through double per channel 
+// the way Ease does it vs one Q14 weight and the saturating blend
+void benchFixed() {
+  const size_t kBytes = 4 << 20;
+  const int kFrames = 20;
+  vector<uint8_t> from(kBytes), to(kBytes, 255), out(kBytes);
+  for (size_t i = 0; i < kBytes; i++) from[i] = uint8_t(i * 7);
+  const FixedCurve curve(Ease::InOutCubic);
+  
+  clock_t begin = clock();
+  for (int f = 0; f < kFrames; f++) {
+    const double t = double(f) / kFrames;
+    for (size_t i = 0; i < kBytes; i++) {
+      double v = Ease::InOutCubic(t, double(from[i]), double(to[i]) - from[i], 1);
+      out[i] = uint8_t(v < 0 ? 0 : (v > 255 ? 255 : v + .5));
+    }
+  }
+  clock_t mid = clock();
+  for (int f = 0; f < kFrames; f++) {
+    FixedBatch::lerp(&from[0], &to[0], curve.at(double(f) / kFrames), &out[0], kBytes);
+  }
+  clock_t end = clock();
+  
+  double ms = 1e3 / CLOCKS_PER_SEC / kFrames;
+  cout << "double per channel: " << double(mid - begin) * ms << " ms, fixed: " 
+       << double(end - mid) * ms << " ms per " << (kBytes >> 20) << " MB frame" << endl;
+}
+
+#ifdef ANI_HAS_SCHEDULER
+// Many scenes of skewed size, one after the other vs on the pool. Wall time,
+// clock() would add up the workers.
+void benchScheduler(size_t threads) {
+  const int kScenes = 200;
+  vector<Ani> scenes(kScenes);
+  vector<vector<float> > vars(kScenes);
+  for (int i = 0; i < kScenes; i++) {
+    vars[i].resize(i % 10 ? 20 : 2000);
+    for (size_t v = 0; v < vars[i].size(); v++) {
+      scenes[i].mate(&vars[i][v])->go(1e9, 10, Ease::InOutCubic);
+    }
+  }
+  
+  Scheduler scheduler(threads);
+  for (int i = 0; i < kScenes; i++) {
+    scheduler.add(&scenes[i]);
+  }
+  
+  typedef std::chrono::steady_clock wall;
+  const int kRuns = 100;
+  wall::time_point begin = wall::now();
+  for (int r = 0; r < kRuns; r++) {
+    for (int i = 0; i < kScenes; i++) scenes[i].update(r);
+  }
+  wall::time_point mid = wall::now();
+  for (int r = 0; r < kRuns; r++) {
+    scheduler.update(r);
+  }
+  wall::time_point end = wall::now();
+  
+  double ms = 1e3 / kRuns;
+  cout << kScenes << " scenes, one by one: " 
+       << std::chrono::duration<double>(mid - begin).count() * ms << " ms, on " 
+       << threads << " threads: " 
+       << std::chrono::duration<double>(end - mid).count() * ms << " ms" << endl;
+}
+#endif
+
+int main (int argc, char const *argv[])
+{
+  // ------ Easing ------------------------------------------------------------
+  cout << "Easing\n" << endl;
+  
+  benchEase("Ease::InOutCubic", Ease::InOutCubic);
+  benchEase("Ease::OutExpo", Ease::OutExpo);
+  benchEase("Ease::InOutSine", Ease::InOutSine);
+  benchEase("EaseFast::InOutSine", EaseFast::InOutSine);
+  benchEase("EaseFast::OutExpo", EaseFast::OutExpo);
+  benchEase("Ease::InOutExpo", Ease::InOutExpo);
+  benchEase("EaseFast::InOutExpo", EaseFast::InOutExpo);
+  benchEase("Ease::InOutCirc", Ease::InOutCirc);
+  benchEase("EaseFast::InOutCirc", EaseFast::InOutCirc);
+  benchEase("EaseBezier(.25, .1, .25, 1)", EaseBezier::method<float>(.25, .1, .25, 1));
+  benchEase("EaseBezier(.42, 0, .58, 1)", EaseBezier::method<float>(.42, 0, .58, 1));
+  
+  // ------ Batched fast easing -----------------------------------------------
+  cout << "\n\nEaseFast::batch()\n" << endl;
+  
+  benchBatch<EaseFast::inOutSine>("inOutSine");
+  benchBatch<EaseFast::outExpo>("outExpo");
+  benchBatch<EaseFast::inOutExpo>("inOutExpo");
+  benchBatch<EaseFast::inOutCirc>("inOutCirc");
+  
+  // ------ Compact updates ---------------------------------------------------
+  cout << "\n\nCompact update()\n" << endl;
+  
+  double single = benchCompact("InOutCubic, Repeat only", false);
+  double mixed  = benchCompact("every curve, Repeat & PingPong", true);
+  cout << "mix over single curve: " << mixed / single << "x" << endl;
+  
+  // ------ Sampling ----------------------------------------------------------
+  cout << "\n\nsample()\n" << endl;
+  
+  benchSample();
+  
+  // ------ Batched setters ---------------------------------------------------
+  cout << "\n\nbatch()\n" << endl;
+  
+  benchSetter("setter per object", false);
+  benchSetter("bulk setter", true);
+  
+  // ------ Prototypes --------------------------------------------------------
+  cout << "\n\nprototype()\n" << endl;
+  
+  benchPrototype("go() per animation", false);
+  benchPrototype("prototype instances", true);
+  
+  // ------ Vectors -----------------------------------------------------------
+  cout << "\n\nVectorBatch, " << kRecords << " values\n" << endl;
+  
+  benchVectors();
+  
+  // ------ Settling ----------------------------------------------------------
+  cout << "\n\nsetSettle()\n" << endl;
+  
+  benchSettle("run to the end", 0);
+  benchSettle("settle at 1/255", 1 / 255.0);
+  
+  // ------ Baking ------------------------------------------------------------
+  cout << "\n\nBakeWriter & BakeStream\n" << endl;
+  
+  benchBake();
+  
+  // ------ Fixed point -------------------------------------------------------
+  cout << "\n\nFixedBatch::lerp()\n" << endl;
+  
+  benchFixed();
+  
+#ifdef ANI_HAS_SCHEDULER
+  // ------ Scheduler ---------------------------------------------------------
+  cout << "\n\nScheduler\n" << endl;
+  
+  benchScheduler(std::max(1u, std::thread::hardware_concurrency()));
+#endif
+  
+  return 0;
+}
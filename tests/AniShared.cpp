@@ -0,0 +1,117 @@
+#include "../include/Ani.h"
+#include "../include/Shared.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace std;
+using namespace rp;
+
+/*
+  Two process check of the shared memory output: the parent animates a 
+  frame of values, a forked child reads it back and fails on torn frames.
+  
+    g++ -std=c++11 -O2 tests/AniShared.cpp -o anishared && ./anishared
+    ./anishared --frames 100000 --slots 256 --live 50
+  
+  Slot i runs the same tween offset by i, so in a consistent frame every
+  value minus its index is the same. A frame mixing two publishes would 
+  show two different ones. The child also fails unless it read at least
+  --live different frames while the parent was still publishing.
+*/
+
+static const char* kName = "/ani_shared_test";
+
+static int subscribe(size_t slots, long frames, long live) {
+  SharedSubscriber<float> in;
+  for (int i = 0; i < 1000 && !in.open(kName); i++) {
+    usleep(1000);
+  }
+  if (!in.isOpen() || in.size() != slots) {
+    printf("subscriber: can't open %s\n", kName);
+    return 1;
+  }
+  
+  vector<float> frame(slots);
+  uint64_t n = 0, last = 0;
+  long reads = 0, torn = 0, busy = 0, during = 0;
+  
+  while (last < uint64_t(frames)) {
+    if (!in.read(&frame[0], slots, &n)) {
+      busy++;
+      continue;
+    }
+    if (n == last) {
+      usleep(0); // let the publisher get ahead
+      continue;
+    }
+    reads++;
+    if (n < uint64_t(frames)) 
+      during++; // the last frame is the only one read after the run
+    for (size_t i = 1; i < slots; i++) {
+      if (std::fabs((frame[i] - i) - frame[0]) > 1e-2f) {
+        torn++;
+        break;
+      }
+    }
+    last = n;
+  }
+  
+  printf("subscriber: %ld frames, %ld while publishing, %ld torn, %ld busy\n", 
+         reads, during, torn, busy);
+  return (torn || during < live) ? 1 : 0;
+}
+
+int main (int argc, char const *argv[])
+{
+  long   frames = 20000;
+  size_t slots  = 1024;
+  long   live   = 50;
+  
+  for (int i = 1; i + 1 < argc; i += 2) {
+    if (!strcmp(argv[i], "--frames")) frames = atol(argv[i + 1]);
+    if (!strcmp(argv[i], "--slots"))  slots  = size_t(atol(argv[i + 1]));
+    if (!strcmp(argv[i], "--live"))   live   = atol(argv[i + 1]);
+  }
+  
+  SharedSegment::unlink(kName);
+  SharedPublisher<float> out(kName, slots);
+  if (!out.isOpen()) {
+    printf("publisher: can't create %s\n", kName);
+    return 1;
+  }
+  
+  Ani ani;
+  for (size_t i = 0; i < slots; i++) {
+    *out.slot(i) = float(i);
+    ani.mate(out.slot(i))->go(1.0, float(i + 100), Ease::InOutSine, new Timing::PingPong());
+  }
+  
+  pid_t child = fork();
+  if (child == 0) {
+    int result = subscribe(slots, frames, live);
+    fflush(stdout);
+    _exit(result);
+  }
+  
+  for (long f = 0; f < frames; f++) {
+    out.update(ani, f / 1000.0);
+  }
+  
+  // Keep the segment up until the child saw the last frame
+  int status = 0;
+  waitpid(child, &status, 0);
+  
+  printf("publisher: %lu frames of %lu values\n", 
+         (unsigned long)out.frame(), (unsigned long)slots);
+  if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+    printf("FAILED\n");
+    return 1;
+  }
+  printf("OK\n");
+  return 0;
+}
@@ -0,0 +1,243 @@
+#include "../include/Ani.h"
+#include "../include/Scheduler.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#if __cplusplus >= 201103L
+#include <atomic>
+#endif
+
+using namespace std;
+using namespace rp;
+
+/*
+  Soak test: drives a randomized mate/go/stop/remove/update workload and
+  fails if a warmed up Ani keeps allocating or growing.
+  
+    g++ -O2 tests/AniSoak.cpp -o anisoak && ./anisoak
+    ./anisoak --ticks 5000000 --warmup 200000 --allocs 0.0001 --rss 1024
+    ./anisoak --evict 30    # recycle animators idle for 30 ticks
+  
+  With C++11 two more Anis run on a Scheduler, fed with go() from the main
+  thread, so blocks get freed on a different thread than they came from.
+  
+  The live object count is bounded, but a random workload keeps creeping
+  up to new peaks for a long while, and the pool grows one block each time.
+  Hence an allocation budget per tick instead of a hard zero.
+*/
+
+// ------ Count every global allocation ---------------------------------------
+#if __cplusplus >= 201103L
+static std::atomic<size_t> gAllocs(0);
+#else
+static size_t gAllocs = 0;
+#endif
+
+void* operator new(size_t size) {
+  gAllocs++;
+  void* p = malloc(size ? size : 1);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+void* operator new[](size_t size) {
+  gAllocs++;
+  void* p = malloc(size ? size : 1);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+void operator delete(void* p) throw() { free(p); }
+void operator delete[](void* p) throw() { free(p); }
+#if __cplusplus >= 201402L
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+#endif
+
+// ------ Resident set size in kB ---------------------------------------------
+static long rssKb() {
+  long pages = 0, resident = 0;
+  FILE* f = fopen("/proc/self/statm", "r");
+  if (!f) return 0;
+  if (fscanf(f, "%ld %ld", &pages, &resident) != 2) resident = 0;
+  fclose(f);
+  return resident * 4;
+}
+
+// ------ Small deterministic generator, rand() may lock or allocate ----------
+static unsigned int gSeed = 12345;
+static unsigned int rnd() {
+  gSeed = gSeed * 1103515245u + 12345u;
+  return (gSeed >> 16) & 0x7fff;
+}
+static double rndUnit() {
+  return rnd() / 32767.0;
+}
+
+class Target
+{
+public:
+  Target () : value(0), finishes(0) {}
+  void set(float v) { value = v; }
+  void finished() { finishes++; }
+  
+  float value;
+  int   finishes;
+};
+
+static TimeBase* randomTiming() {
+  switch (rnd() % 4) {
+    case 0:  return new Timing::Repeat(1 + rnd() % 3);
+    case 1:  return new Timing::PingPong(1 + rnd() % 2);
+    default: return new Timing::Linear();
+  }
+}
+
+static EaseKind::Type randomEase() {
+  return EaseKind::Type(rnd() % EaseKind::Count);
+}
+
+int main (int argc, char const *argv[])
+{
+  long   ticks     = 2000000;
+  long   warmup    = 200000;
+  double allocs    = 1e-4; // allowed allocations per tick after warmup
+  long   rssBudget = 1024; // allowed growth in kB after warmup
+  long   evict     = 0;    // idle ticks before eviction, 0 for never
+  
+  for (int i = 1; i + 1 < argc; i += 2) {
+    if (!strcmp(argv[i], "--ticks"))  ticks     = atol(argv[i + 1]);
+    if (!strcmp(argv[i], "--warmup")) warmup    = atol(argv[i + 1]);
+    if (!strcmp(argv[i], "--allocs")) allocs    = atof(argv[i + 1]);
+    if (!strcmp(argv[i], "--rss"))    rssBudget = atol(argv[i + 1]);
+    if (!strcmp(argv[i], "--evict"))  evict     = atol(argv[i + 1]);
+  }
+  
+  const int kVars = 256, kTargets = 32, kSprings = 64, kStrips = 16, kOps = 4;
+  
+  static float  vars[kVars];
+  static float  compacts[kVars];
+  static float  springVars[kSprings];
+  static uint8_t strips[kStrips][60], lit[60];
+  static Target targets[kTargets];
+  uint32_t      springs[kSprings];
+  
+  Ani ani;
+  ani.deferEvents(1024);
+  ani.setIdlePolicy(uint32_t(evict));
+  
+  for (int i = 0; i < kSprings; i++) {
+    springs[i] = ani.springs<float>()->add(&springVars[i]);
+  }
+  
+#ifdef ANI_HAS_SCHEDULER
+  const int kScenes = 2;
+  static float sceneVars[kScenes][kVars];
+  Ani scenes[kScenes];
+  Scheduler scheduler(kScenes);
+  for (int s = 0; s < kScenes; s++) {
+    scheduler.add(&scenes[s]);
+  }
+#endif
+  
+  size_t startAllocs = 0;
+  long   startRss = 0;
+  double ttime = 0;
+  
+  for (long tick = 0; tick < ticks; tick++) {
+    if (tick == warmup) {
+      startAllocs = gAllocs;
+      startRss = rssKb();
+    }
+    
+    for (int op = 0; op < kOps; op++) {
+      int v = rnd() % kVars;
+      
+      switch (rnd() % 9) {
+        // ------ go() on idle variables ----------------------------------------
+        case 0: case 1: {
+          varAnimator<float>* a = ani.mate(&vars[v]);
+          if (!a->isAnimating()) {
+            a->go(0.1 + rndUnit(), float(rnd() % 100), 
+                  EaseTable<float>::method(randomEase()), randomTiming());
+          }
+          break;
+        }
+        // ------ Built up animation with callbacks -----------------------------
+        case 2: {
+          Target& t = targets[rnd() % kTargets];
+          AnimatorImpl<float>* a = ani.mate(&t, &Target::set);
+          if (!a->isAnimating()) {
+            ani.mate(&t, &Target::set)->anim(0.1 + rndUnit(), 0, float(rnd() % 100))
+                                      ->setDelay(rndUnit() * 0.2)
+                                      ->setCallbackFinish(&t, &Target::finished)
+                                      ->setTimeMethod(randomTiming())
+                                      ->go();
+          }
+          break;
+        }
+        case 3:
+          ani.mate(&vars[v])->stop();
+          break;
+        case 4:
+          ani.remove(&vars[v]);
+          break;
+        case 5:
+          ani.compact<float>()->stop(&compacts[v])
+                              ->go(&compacts[v], 0.1 + rndUnit(), float(rnd() % 100), 
+                                   randomEase());
+          break;
+        // ------ Whole buffers, their beginnings are reused --------------------
+        case 6: {
+          uint8_t* strip = strips[rnd() % kStrips];
+          ani.fixed<uint8_t>()->stop(strip)->go(strip, lit, 1 + rnd() % 60, 0.1 + rndUnit());
+          break;
+        }
+        default:
+          ani.springs<float>()->retarget(springs[rnd() % kSprings], float(rnd() % 100));
+          break;
+      }
+    }
+    
+#ifdef ANI_HAS_SCHEDULER
+    // ------ go() here, finished and freed on whichever thread updates it ---
+    for (int s = 0; s < kScenes; s++) {
+      for (int op = 0; op < kOps; op++) {
+        varAnimator<float>* a = scenes[s].mate(&sceneVars[s][rnd() % kVars]);
+        if (!a->isAnimating()) {
+          a->go(0.1 + rndUnit(), float(rnd() % 100), 
+                EaseTable<float>::method(randomEase()), randomTiming());
+        }
+      }
+    }
+#endif
+    
+    ttime += 1.0 / 60;
+    ani.update(ttime);
+#ifdef ANI_HAS_SCHEDULER
+    scheduler.update(ttime);
+#endif
+  }
+  
+  long measured = ticks - warmup;
+  if (measured <= 0) {
+    printf("nothing measured, ticks must exceed warmup\n");
+    return 1;
+  }
+  
+  double perTick = double(gAllocs - startAllocs) / measured;
+  long   growth  = rssKb() - startRss;
+  
+  printf("ticks: %ld (warmup %ld)\n", ticks, warmup);
+  printf("allocations: %lu, per tick: %g (budget %g)\n", 
+         (unsigned long)(gAllocs - startAllocs), perTick, allocs);
+  printf("rss growth: %ld kB (budget %ld kB)\n", growth, rssBudget);
+  printf("dropped events: %lu\n", (unsigned long)ani.events().dropped());
+  printf("removal & eviction passes: %lu\n", (unsigned long)ani.generation());
+  
+  if (perTick > allocs || growth > rssBudget) {
+    printf("FAILED\n");
+    return 1;
+  }
+  printf("OK\n");
+  return 0;
+}
@@ -1,6 +1,8 @@
 #include "../include/Ani.h"
 #include "../include/Ease.h"
 #include "../include/Timing.h"
+#include "../include/Scheduler.h"
+#include "../include/Bake.h"
 #include <map>
 
 using namespace std;
@@ -29,6 +31,87 @@ public:
   }
 };
 
+// ------ Bulk setter for batched function animations -------------------------
+class tEntity
+{
+public:
+  tEntity () : x(0) {}
+  void setX(float v) { x = v; }
+  float x;
+};
+
+void setEntityX(tEntity* const* objs, const float* values, size_t n) {
+  cout << "bulk setX: " << n << " values" << endl;
+  for (size_t i = 0; i < n; i++) {
+    objs[i]->x = values[i];
+  }
+}
+
+// ------ Penner's original Bounce & Elastic, for checking Ease -----------------
+double pennerOutBounce(double t, double b, double c, double d) {
+  if ((t/=d) < (1/2.75)) {
+    return c*(7.5625*t*t) + b;
+  } else if (t < (2/2.75)) {
+    t -= (1.5/2.75);
+    return c*(7.5625*t*t + .75) + b;
+  } else if (t < (2.5/2.75)) {
+    t -= (2.25/2.75);
+    return c*(7.5625*t*t + .9375) + b;
+  } else {
+    t -= (2.625/2.75);
+    return c*(7.5625*t*t + .984375) + b;
+  }
+}
+double pennerInBounce(double t, double b, double c, double d) {
+  return c - pennerOutBounce(d-t, 0, c, d) + b;
+}
+double pennerInOutBounce(double t, double b, double c, double d) {
+  if (t < d/2) return pennerInBounce(t*2, 0, c, d) * .5 + b;
+  return pennerOutBounce(t*2-d, 0, c, d) * .5 + c*.5 + b;
+}
+double pennerInElastic(double t, double b, double c, double d) {
+  if (t==0) return b;
+  if ((t/=d)==1) return b+c;
+  double p = d*.3, s = p/4;
+  t -= 1;
+  return -(c*pow(2, 10*t) * sin((t*d-s)*(2*PI)/p)) + b;
+}
+double pennerOutElastic(double t, double b, double c, double d) {
+  if (t==0) return b;
+  if ((t/=d)==1) return b+c;
+  double p = d*.3, s = p/4;
+  return c*pow(2, -10*t) * sin((t*d-s)*(2*PI)/p) + c + b;
+}
+double pennerInOutElastic(double t, double b, double c, double d) {
+  if (t==0) return b;
+  if ((t/=d/2)==2) return b+c;
+  double p = d*(.3*1.5), s = p/4;
+  t -= 1;
+  if (t < 0) return -.5*(c*pow(2, 10*t) * sin((t*d-s)*(2*PI)/p)) + b;
+  return c*pow(2, -10*t) * sin((t*d-s)*(2*PI)/p)*.5 + c + b;
+}
+
+void checkEase(const char* name, double (*ease)(double t, double b, double c, double d),
+               double (*penner)(double t, double b, double c, double d)) 
+{
+  double maxErr = 0;
+  for (int i = 0; i <= 1000; i++) {
+    double t = i * 2.0 / 1000; // d = 2, b = 3, c = -5
+    maxErr = max(maxErr, fabs(ease(t, 3, -5, 2) - penner(t, 3, -5, 2)));
+  }
+  cout << name << ": " << ease(.6, 3, -5, 2) 
+       << (maxErr < 1e-9 ? ", matches Penner" : ", DOESN'T match Penner") << endl;
+}
+
+#ifdef ANI_HAS_COROUTINES
+Script sequence(Ani& ani, float* x, float* y) {
+  cout << "Script: moving x" << endl;
+  co_await finished(ani.mate(x)->go(.3, 10));
+  cout << "Script: x done, moving y" << endl;
+  co_await finished(ani.mate(y)->go(.3, 20, Ease::OutExpo));
+  cout << "Script: y done" << endl;
+}
+#endif
 
 int main (int argc, char const *argv[])
 {
@@ -104,6 +187,480 @@ int main (int argc, char const *argv[])
     ani.update(i);
   }
   
+  // ------ Compact animations ------------------------------------------------
+  cout << "\n\nCompact go()\n" << endl;
+  cout << "sizeof(Animation<float>): " << sizeof(Animation<float>) 
+       << ", sizeof(CompactAnimation<float>): " << sizeof(CompactAnimation<float>) 
+       << endl;
+  
+  float cvar = 2, dvar = 2;
+  ani.setTimeOrigin(3600);
+  ani.compact<float>()->go(&cvar, .8, 6, EaseKind::OutExpo);
+  ani.mate(&dvar)->go(.8, 6, Ease::OutExpo, new Timing::Linear());
+  
+  float maxErr = 0;
+  for (double i = 3600; i <= 3602; i += .1) {
+    ani.update(i);
+    maxErr = max(maxErr, fabsf(cvar - dvar));
+    cout << "time: " << i << ", Var: " << cvar << endl;
+  }
+  cout << "max error vs double path: " << maxErr << endl;
+  
+  // ------ Path animation ----------------------------------------------------
+  cout << "\n\nPath follow()\n" << endl;
+  
+  double pts[] = { 0, 10, 11, 30 };
+  Path<double> path(Path<double>::CatmullRom, pts, 4);
+  double pvar = 0;
+  
+  ani.follow(&pvar, &path)->go(1.0, Ease::InOutCubic);
+  
+  for (double i = 3602; i <= 3603.2; i += .1) {
+    ani.update(i);
+    cout << "time: " << i << ", Var: " << pvar << endl;
+  }
+  cout << "path length: " << path.length() << endl;
+  
+  Path<double> empty(Path<double>::CatmullRom, pts, 0);
+  Path<double> single(Path<double>::CatmullRom, pts + 3, 1);
+  Path<double> shortBezier(Path<double>::Bezier, pts, 3);
+  cout << "degenerate paths: " << empty.at(.5) << ", " << single.at(.5) << ", " 
+       << shortBezier.at(.5) << ", lengths: " << empty.length() + single.length() + 
+          shortBezier.length() << endl;
+  
+  // ------ Cubic bezier easing -----------------------------------------------
+  cout << "\n\nCubic bezier go()\n" << endl;
+  float bvar = 0;
+  
+  ani.mate(&bvar)->go(1.0, 10, EaseBezier::method<float>(.25, .1, .25, 1));
+  
+  for (double i = 3604; i <= 3605.2; i += .1) {
+    ani.update(i);
+    cout << "time: " << i << ", Var: " << bvar << endl;
+  }
+  
+  float (*overflow)(double, float, float, double) = 0;
+  for (int i = 0; i <= ANI_BEZIER_CURVES; i++) {
+    overflow = EaseBezier::method<float>(.5, i / 100.0, .5, 1);
+  }
+  cout << "out of slots falls back to linear: " 
+       << (overflow == &Ease::NoneLinear<float> ? "yes" : "no") << endl;
+  
+  // ------ Springs -----------------------------------------------------------
+  cout << "\n\nSpring retarget()\n" << endl;
+  float svar = 0;
+  
+  springAnimator<float>* springs = ani.springs<float>();
+  uint32_t spring = springs->add(&svar, 170, 26);
+  springs->retarget(spring, 10);
+  
+  for (double i = 3606; i <= 3608; i += .1) {
+    if (i > 3606.35 && i < 3606.45) 
+      springs->retarget(spring, 4); // mid flight
+    ani.update(i);
+    cout << "time: " << i << ", Var: " << svar 
+         << (springs->isSleeping(spring) ? " (sleeping)" : "") << endl;
+  }
+  
+  float stale = 0, kept = 0;
+  uint32_t staleSpring = springs->add(&stale);
+  uint32_t keptSpring = springs->add(&kept);
+  springs->remove(staleSpring);
+  springs->remove(staleSpring); // second remove is ignored
+  springs->retarget(staleSpring, 5);
+  springs->retarget(keptSpring, 1);
+  cout << "after stale remove, springs: " << springs->size() << ", kept valid: " 
+       << springs->valid(keptSpring) << ", stale valid: " << springs->valid(staleSpring) 
+       << ", kept awake: " << !springs->isSleeping(keptSpring) << endl;
+  springs->remove(keptSpring);
+  
+  // ------ Deferred events ---------------------------------------------------
+  cout << "\n\nDeferred events\n" << endl;
+  Ani deferred;
+  deferred.deferEvents(64, false);
+  float evar = 0;
+  
+  deferred.mate(&evar)->anim(.3, 5)
+                      ->setEventId(7)
+                      ->setCallbackFinish(&test, &tClass::animCallbackFinish)
+                      ->go();
+  
+  for (double i = 0; i <= .5; i += .1) {
+    deferred.update(i);
+    cout << "time: " << i << ", Var: " << evar << endl;
+    for (size_t e = 0; e < deferred.events().size(); e++) {
+      cout << "event id: " << deferred.events()[e].id 
+           << ", kind: " << int(deferred.events()[e].kind) << endl;
+    }
+    deferred.events().dispatch();
+  }
+  
+  // ------ Bounce & Elastic -------------------------------------------------
+  cout << "\n\nBounce & Elastic\n" << endl;
+  
+  checkEase("InBounce", Ease::InBounce, pennerInBounce);
+  checkEase("OutBounce", Ease::OutBounce, pennerOutBounce);
+  checkEase("InOutBounce", Ease::InOutBounce, pennerInOutBounce);
+  checkEase("InElastic", Ease::InElastic, pennerInElastic);
+  checkEase("OutElastic", Ease::OutElastic, pennerOutElastic);
+  checkEase("InOutElastic", Ease::InOutElastic, pennerInOutElastic);
+  
+  // ------ Relative animations ----------------------------------------------
+  cout << "\n\nRelative go()\n" << endl;
+  float nodes[2] = { 0, 0 }; // child is stored first, the map would visit it first
+  float& child = nodes[0];
+  float& parent = nodes[1];
+  
+  ani.relative(&child, &parent)->setLocal(1)->go(1.0, 3);
+  ani.mate(&parent)->go(1.0, 10);
+  
+  for (double i = 3611; i <= 3612.2; i += .2) {
+    ani.update(i);
+    cout << "time: " << i << ", parent: " << parent << ", child: " << child << endl;
+  }
+  
+  float late = 4;
+  ani.mate(&late)->go(1.0, 50); // plain first, replaced below
+  relativeAnimator<float>* lateRel = ani.relative(&late, &parent);
+  lateRel->go(1.0, 2);
+  for (double i = 3612.4; i <= 3613.5; i += .5) {
+    ani.update(i);
+  }
+  cout << "replaced plain animator, late: " << late << ", mate() is relative: " 
+       << (ani.mate(&late) == lateRel) << endl;
+  
+  // ------ Interval index ---------------------------------------------------
+  cout << "\n\nInterval query()\n" << endl;
+  Ani timeline;
+  timeline.indexIntervals();
+  float ivar = 0, jvar = 0;
+  
+  timeline.mate(&ivar)->go(1.0, 5)->go(1.0, 0)->go(.5, 2);
+  timeline.mate(&jvar)->anim(2.0, 5)->setDelay(.5)->go();
+  timeline.update(10);
+  timeline.update(10.1);
+  
+  vector<const IntervalNode*> hits;
+  timeline.intervals().query(11.2, 11.4, hits);
+  timeline.intervals().stab(12.2, hits);
+  for (size_t i = 0; i < hits.size(); i++) {
+    cout << "start: " << hits[i]->start << ", end: " << hits[i]->end << endl;
+  }
+  cout << "indexed: " << timeline.intervals().size() << endl;
+  
+  // ------ Sampling ---------------------------------------------------------
+  cout << "\n\nsample()\n" << endl;
+  Ani sampled;
+  float qvar = 0, qcvar = 0;
+  
+  sampled.mate(&qvar)->go(1.0, 10, Ease::InOutCubic, new Timing::PingPong(1));
+  sampled.compact<float>()->go(&qcvar, 1.0, 10, EaseKind::InOutCubic, TimingKind::PingPong, 1);
+  sampled.update(0);
+  sampled.update(.5);
+  
+  double times[] = { 0, .5, 1, 1.5, 2, 2.5 };
+  float rows[2][6];
+  AnimationBase<float>* anims[] = { sampled.mate(&qvar)->getCurrentAnimation() };
+  sampleAnimations(anims, 1, times, 6, rows[0], .5);
+  sampled.compact<float>()->sample(times, 6, rows[1], .5);
+  
+  for (int i = 0; i < 6; i++) {
+    cout << "time: " << times[i] << ", Var: " << rows[0][i] 
+         << ", compact: " << rows[1][i] << endl;
+  }
+  sampled.update(1.5);
+  cout << "still at time 1.5, Var: " << qvar << ", compact: " << qcvar << endl;
+  
+  float fvar = 0, fsamples[5];
+  double ftimes[] = { 2, 2.25, 2.5, 2.75, 3 };
+  bool fmatch = true;
+  sampled.mate(&fvar)->go(1.0, 10, EaseFast::OutExpo);
+  sampled.update(2);
+  AnimationBase<float>* fast[] = { sampled.mate(&fvar)->getCurrentAnimation() };
+  sampleAnimations(fast, 1, ftimes, 5, fsamples, 2);
+  for (int i = 0; i < 5; i++) {
+    sampled.update(ftimes[i]);
+    fmatch = fmatch && fsamples[i] == fvar;
+  }
+  cout << "EaseFast kernel matches update(): " << (fmatch ? "yes" : "no") << endl;
+  
+  // ------ Idle eviction -----------------------------------------------------
+  cout << "\n\nIdle eviction\n" << endl;
+  Ani registry;
+  registry.setIdlePolicy(2);
+  float idle[4] = { 0, 0, 0, 0 };
+  
+  registry.relative(&idle[2], &idle[0]); // linked pair stays
+  for (int i = 0; i < 4; i++) {
+    registry.mate(&idle[i])->go(.5 * (i + 1), 1);
+  }
+  registry.mate(&idle[3])->pin();
+  AniHandle<varAnimator<float>, float*> held = registry.handle(&idle[1]);
+  
+  for (double i = 0; i <= 2.5; i += .5) {
+    registry.update(i);
+    cout << "time: " << i << ", generation: " << registry.generation() << endl;
+  }
+  held->go(1.0, 5);
+  for (double i = 3; i <= 4; i += .5) {
+    registry.update(i);
+    cout << "time: " << i << ", handle: " << idle[1] << endl;
+  }
+  cout << "bulk evicted: " << registry.evictIdle() << endl;
+  
+  // ------ Batched setters --------------------------------------------------
+  cout << "\n\nbatch()\n" << endl;
+  Ani batched;
+  tEntity entities[3];
+  batchAnimator<tEntity, float>* xs = batched.batch(&tEntity::setX, setEntityX);
+  
+  for (int i = 0; i < 3; i++) {
+    xs->go(&entities[i], 1.0, 0, float(10 * (i + 1)), Ease::NoneLinear, .5 * i);
+  }
+  for (double i = 0; i <= 2.5; i += .5) {
+    batched.update(i);
+    cout << "time: " << i << ", x: " << entities[0].x << ", " 
+         << entities[1].x << ", " << entities[2].x << ", playing: " << xs->size() << endl;
+  }
+  
+  // ------ Prototypes -------------------------------------------------------
+  cout << "\n\nprototype()\n" << endl;
+  Ani styled;
+  float pvars[3] = { 0, 0, 0 };
+  prototypeAnimator<float>* style = 
+    styled.prototype(AnimationStyle<float>(1.0, Ease::InOutCubic));
+  
+  style->go(&pvars[0], 10);
+  styled.update(0);
+  style->go(&pvars[1], 10);
+  prototypeAnimator<float>* slower = styled.prototype(style->derive().setDuration(2.0));
+  slower->go(&pvars[2], 10);
+  
+  for (double i = .5; i <= 2.5; i += .5) {
+    styled.update(i);
+    cout << "time: " << i << ", Vars: " << pvars[0] << ", " << pvars[1] << ", " 
+         << pvars[2] << ", playing: " << style->size() + slower->size() << endl;
+  }
+  
+  // ------ Vectors & quaternions ---------------------------------------------
+  cout << "\n\nVec3 & Quat go()\n" << endl;
+  Ani spatial;
+  Vec3 position;
+  Quat rotation = Quat::axisAngle(Vec3(0, 0, 1), 0);
+  Quat turned = Quat::axisAngle(Vec3(0, 0, 1), 3);
+  
+  spatial.mate(&position)->go(1.0, Vec3(1, 2, 3), Ease::OutCubic);
+  spatial.mate(&rotation)->go(1.0, -turned); // -q is the same rotation
+  for (double i = 0; i <= 1; i += .25) {
+    spatial.update(i);
+    cout << "time: " << i << ", position: " << position.x << ", " << position.y 
+         << ", " << position.z << ", angle: " << 2 * std::acos(rotation.w) 
+         << ", length: " << rotation.length() << endl;
+  }
+  
+  Quat from[7], to[7], nl[7], sl[7];
+  float progress[7];
+  float worst = 0;
+  for (int i = 0; i < 7; i++) {
+    from[i] = Quat::axisAngle(Vec3(1, 0, 0), .3 * i);
+    to[i] = Quat::axisAngle(Vec3(0, 1, 0), 1 - .4 * i);
+    progress[i] = i / 6.0f;
+  }
+  VectorBatch::nlerp(from, to, progress, nl, 7);
+  VectorBatch::slerp(from, to, progress, sl, 7);
+  for (int i = 0; i < 7; i++) {
+    Quat a = Quat::nlerp(from[i], to[i], progress[i]);
+    Quat b = Quat::slerp(from[i], to[i], progress[i]);
+    worst = std::max(worst, std::max((nl[i] - a).length(), (sl[i] - b).length()));
+  }
+  cout << "batch matches scalar: " << (worst < 1e-5f ? "yes" : "no") << endl;
+  
+  // ------ Settling ---------------------------------------------------------
+  cout << "\n\nsetSettle()\n" << endl;
+  Ani settling;
+  settling.setSettle(.05);
+  float fullVar = 0, settledVar = 0, backVar = 0;
+  
+  settling.mate(&fullVar)->setSettle(0);
+  settling.mate(&fullVar)->go(1.0, 10, Ease::OutExpo);
+  settling.mate(&settledVar)->go(1.0, 10, Ease::OutExpo)
+                            ->anim(.5, 20)->setCallbackFinish(&test, &tClass::animCallbackFinish)
+                            ->go();
+  settling.mate(&backVar)->go(1.0, 10, Ease::OutBack);
+  for (double i = 0; i <= 1.6; i += .1) {
+    settling.update(i);
+    cout << "time: " << i << ", full: " << fullVar << ", settled: " << settledVar 
+         << ", back: " << backVar << endl;
+  }
+  
+  // ------ Baked curves -------------------------------------------------------
+  cout << "\n\nBakeWriter & BakeStream\n" << endl;
+  std::vector<float> frames[2];
+  BakeWriter baking(60);
+  
+  for (int i = 0; i <= 240; i++) {
+    frames[0].push_back(Ease::InOutCubic(i / 240.0, 0.0f, 10.0f, 1));
+    frames[1].push_back(Ease::OutBounce(i / 240.0, 0.0f, 10.0f, 1));
+  }
+  baking.add(&frames[0][0], frames[0].size(), 1e-3f);
+  baking.add(&frames[1][0], frames[1].size(), 1e-3f);
+  
+  SnapshotWriter baked;
+  baking.write(baked);
+  BakedCurves curves;
+  cout << "opened: " << curves.open(&baked.data()[0], baked.size()) 
+       << ", truncated: " << BakedCurves().open(&baked.data()[0], baked.size() - 1) << endl;
+  
+  for (size_t c = 0; c < curves.channels(); c++) {
+    BakeStream stream(curves, c);
+    float worst = 0;
+    for (size_t i = 0; i < frames[c].size(); i++) {
+      worst = std::max(worst, std::fabs(stream.at(i / 60.0) - frames[c][i]));
+    }
+    cout << "channel: " << c << ", segments: " << curves.channel(c).segments 
+         << ", within tolerance: " << (worst <= 1e-3f ? "yes" : "no") 
+         << ", at 2.5: " << curves.value(c, 2.5) << endl;
+  }
+  cout << "raw bytes: " << 2 * 241 * sizeof(float) << ", baked bytes: " << baked.size() << endl;
+  
+  // A repeated start would make a zero length span
+  std::vector<char> corrupt(baked.data());
+  BakeSegment* spans = reinterpret_cast<BakeSegment*>(
+    &corrupt[sizeof(BakeHeader) + curves.channels() * sizeof(BakeChannel)]);
+  spans[1].start = spans[0].start;
+  cout << "repeated segment start opens: " << BakedCurves().open(&corrupt[0], corrupt.size()) << endl;
+  
+  // ------ Fixed point buffers ------------------------------------------------
+  cout << "\n\nfixed()\n" << endl;
+  Ani fading;
+  static const FixedCurve overshoot(Ease::OutBack);
+  uint8_t pixels[19], light[19];
+  int16_t offsets[11], targets[11];
+  
+  for (int i = 0; i < 19; i++) {
+    pixels[i] = uint8_t(i * 13);
+    light[i] = 200;
+  }
+  for (int i = 0; i < 11; i++) {
+    offsets[i] = int16_t(i * 1000 - 5000);
+    targets[i] = int16_t(i % 2 ? -32768 : 32767);
+  }
+  fading.fixed<uint8_t>()->go(pixels, light, 19, 1.0, &overshoot);
+  fading.fixed<int16_t>()->go(offsets, targets, 11, 1.0, &overshoot, .5);
+  for (double i = 0; i <= 1.6; i += .2) {
+    fading.update(i);
+    cout << "time: " << i << ", pixels: " << int(pixels[0]) << ", " << int(pixels[18]) 
+         << ", offsets: " << offsets[0] << ", " << offsets[1] 
+         << ", playing: " << fading.fixed<uint8_t>()->size() + fading.fixed<int16_t>()->size() 
+         << endl;
+  }
+  
+  uint8_t ba[37], bb[37], simd[37];
+  int mismatches = 0;
+  for (int w = -16383; w <= 32767; w += 997) {
+    for (int i = 0; i < 37; i++) {
+      ba[i] = uint8_t(i * 53);
+      bb[i] = uint8_t(255 - i * 29);
+    }
+    FixedBatch::lerp(ba, bb, int16_t(w), simd, 37);
+    for (int i = 0; i < 37; i++) {
+      FixedBatch::lerp(ba + i, bb + i, int16_t(w), bb + i, 1); // scalar tail only
+      mismatches += simd[i] != bb[i];
+    }
+  }
+  cout << "batch matches scalar: " << (mismatches ? "no" : "yes") << endl;
+  
+  // ------ Snapshots ---------------------------------------------------------
+  cout << "\n\nSnapshot save() & restore()\n" << endl;
+  Ani before, after;
+  float rvar = 0, rcvar = 0, rparent = 5, rchild = 7;
+  SnapshotBinding saving, restoring;
+  
+  saving.bind(1, before.mate(&rvar)->go(1.0, 10, Ease::InOutCubic));
+  saving.bind(3, before.relative(&rchild, &rparent));
+  before.relative(&rchild, &rparent)->go(1.0, 4);
+  saving.bind(2, before.compact<float>()->go(&rcvar, 1.0, 10, EaseKind::OutQuad))
+        ->bindTarget(1, &rcvar);
+  before.update(0);
+  before.update(.5);
+  
+  SnapshotWriter snapshot;
+  before.save(snapshot, saving);
+  cout << "saved " << snapshot.size() << " bytes at Var: " << rvar << endl;
+  
+  rparent = 100; // a fresh relative animator would take -93 as its offset
+  restoring.bind(1, after.mate(&rvar))
+           ->bind(2, after.compact<float>())
+           ->bind(3, after.relative(&rchild, &rparent))
+           ->bindTarget(1, &rcvar);
+  SnapshotReader reader(snapshot.data());
+  cout << "restored animators: " << after.restore(reader, restoring) << endl;
+  
+  for (double i = .6; i <= 1.1; i += .1) {
+    after.update(i);
+    cout << "time: " << i << ", Var: " << rvar << ", compact: " << rcvar 
+         << ", relative: " << rchild - rparent << endl;
+  }
+  
+  // A restarted process, its clock 1000 ahead of the saved one
+  Ani restarted;
+  float lvar = 0, lcvar = 0, lparent = 5, lchild = 0;
+  SnapshotBinding shifting;
+  shifting.bind(1, restarted.mate(&lvar))
+          ->bind(2, restarted.compact<float>())
+          ->bind(3, restarted.relative(&lchild, &lparent))
+          ->bindTarget(1, &lcvar);
+  SnapshotReader shifted(snapshot.data());
+  cout << "restored with offset: " << restarted.restore(shifted, shifting, 1000) << endl;
+  for (double i = 1000.6; i <= 1001.1; i += .1) {
+    restarted.update(i);
+    cout << "time: " << i << ", Var: " << lvar << ", compact: " << lcvar 
+         << ", relative: " << lchild - lparent << endl;
+  }
+  
+#ifdef ANI_HAS_COROUTINES
+  // ------ Coroutine awaitables ----------------------------------------------
+  cout << "\n\nco_await finished()\n" << endl;
+  float xvar = 0, yvar = 0;
+  
+  sequence(ani, &xvar, &yvar);
+  
+  for (double i = 3609; i <= 3610; i += .1) {
+    ani.update(i);
+    cout << "time: " << i << ", x: " << xvar << ", y: " << yvar << endl;
+  }
+#endif
+  
+#ifdef ANI_HAS_SCHEDULER
+  // ------ Scheduler ----------------------------------------------------------
+  cout << "\n\nScheduler update()\n" << endl;
+  Ani scene, menu;
+  float scvar = 0, mnvar = 0;
+  Scheduler scheduler(2);
+  scheduler.add(&scene, 1);
+  scheduler.add(&menu, 0, 2); // twice per time unit
+  
+  scene.mate(&scvar)->go(1.0, 10);
+  menu.mate(&mnvar)->go(1.0, 10);
+  for (double i = 0; i <= 1; i += .25) {
+    size_t updated = scheduler.update(i);
+    cout << "time: " << i << ", updated: " << updated << ", scene: " << scvar 
+         << ", menu: " << mnvar << endl;
+  }
+  cout << "scene updates: " << scheduler.stats(&scene).updates 
+       << ", menu updates: " << scheduler.stats(&menu).updates 
+       << ", menu active: " << scheduler.stats(&menu).active << endl;
+  SchedulerStats sceneStats = scheduler.stats(&scene);
+  Ani extra;
+  scheduler.add(&extra);
+  scheduler.remove(&menu);
+  cout << "kept scene updates: " << sceneStats.updates << ", removed menu: " 
+       << (scheduler.stats(&menu).ani ? "found" : "gone") << endl;
+#endif
+  
+#ifdef ANI_TRACE
+  Trace::write("ani_trace.json");
+#endif
   
   return 0;
 }
\ No newline at end of file